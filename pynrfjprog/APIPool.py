@@ -0,0 +1,223 @@
+"""
+This module keeps opened LowLevel.API instances warm between jobs.
+
+Opening a LowLevel.API starts a new jlinkarm_nrf_worker process, which often takes longer than a short job itself. An
+APIPool keeps the opened instances after use and hands them out again for the same device family and JLinkARM DLL path.
+
+Example:
+    with APIPool.APIPool(max_idle=120) as pool:
+        with pool.checkout('NRF52') as api:
+            api.connect_to_emu_with_snr(snr)
+            api.program_file('image.hex')
+"""
+
+from __future__ import print_function
+
+import contextlib
+import os
+import threading
+import time
+
+try:
+    from . import LowLevel
+    from .APIError import *
+    from .Parameters import *
+except Exception:
+    import LowLevel
+    from APIError import *
+    from Parameters import *
+
+
+class APIPool(object):
+    """
+    Pool of opened LowLevel.API instances, keyed by device family and JLinkARM DLL path.
+
+    Instances are reset with disconnect_from_emu() and select_family() when they are returned, and health-checked with
+    is_open() before being handed out. Instances that fail either step are closed and dropped. Instances idle for longer
+    than max_idle seconds are closed by a background reaper thread.
+    """
+
+    def __init__(self, max_idle=60.0, max_idle_per_key=None, log=False):
+        """
+        Constructor.
+
+        @param (optional) float max_idle: Seconds an instance may stay idle in the pool before it is closed. None keeps idle instances until close().
+        @param (optional) int max_idle_per_key: Maximum number of idle instances kept for each key. Extra instances are closed when returned. None does not limit the count.
+        @param (optional) bool log: Passed to the LowLevel.API instances created by the pool.
+        """
+        if max_idle is not None and max_idle <= 0:
+            raise ValueError('The max_idle parameter must be a positive number of seconds.')
+
+        if max_idle_per_key is not None and (not isinstance(max_idle_per_key, int) or max_idle_per_key < 0):
+            raise ValueError('The max_idle_per_key parameter must be a non-negative integer.')
+
+        self._max_idle = max_idle
+        self._max_idle_per_key = max_idle_per_key
+        self._log = log
+
+        # Key -> list of (api, time returned). The most recently returned instance is last.
+        self._idle = dict()
+        self._keys = dict()
+        self._lock = threading.Lock()
+        self._closed = threading.Event()
+
+        self._reaper = None
+        if max_idle is not None:
+            self._reaper = threading.Thread(target=self._reap_loop, name='APIPool reaper', daemon=True)
+            self._reaper.start()
+
+    @staticmethod
+    def _make_key(device_family, jlink_arm_dll_path):
+        family = decode_enum(device_family, DeviceFamily)
+        if family is None:
+            raise ValueError('Parameter device_family must be of type int, str or DeviceFamily enumeration.')
+
+        if jlink_arm_dll_path is not None:
+            if not isinstance(jlink_arm_dll_path, str):
+                raise ValueError('Parameter jlink_arm_dll_path must be a string.')
+            jlink_arm_dll_path = os.path.abspath(jlink_arm_dll_path)
+
+        return family, jlink_arm_dll_path
+
+    @staticmethod
+    def _discard(api):
+        try:
+            api.close()
+        except (APIError, OSError):
+            pass
+
+    def acquire(self, device_family, jlink_arm_dll_path=None):
+        """
+        Takes an opened API from the pool, or opens a new one if no healthy idle instance is available.
+        The API must be given back with release().
+
+        @param enum, str or int device_family: Device family of the API.
+        @param (optional) str jlink_arm_dll_path: Absolute path to the JLinkARM DLL, see LowLevel.API.
+        @return LowLevel.API: Opened API, not connected to any emulator.
+        """
+        if self._closed.is_set():
+            raise RuntimeError('The pool is closed.')
+
+        key = self._make_key(device_family, jlink_arm_dll_path)
+
+        while True:
+            with self._lock:
+                idle = self._idle.get(key)
+                if not idle:
+                    break
+                api, _ = idle.pop()
+
+            try:
+                if api.is_open():
+                    with self._lock:
+                        self._keys[id(api)] = key
+                    return api
+            except APIError:
+                pass
+            self._discard(api)
+
+        api = LowLevel.API(key[0], jlink_arm_dll_path=key[1], log=self._log)
+        api.open()
+        with self._lock:
+            self._keys[id(api)] = key
+        return api
+
+    def release(self, api, discard=False):
+        """
+        Gives an API back to the pool after resetting it.
+
+        @param LowLevel.API api: API obtained from acquire().
+        @param (optional) bool discard: Close the API instead of keeping it, i.e. after an unexpected error.
+        """
+        with self._lock:
+            key = self._keys.pop(id(api), None)
+        if key is None:
+            raise ValueError('The api parameter was not acquired from this pool.')
+
+        if not discard and not self._closed.is_set():
+            try:
+                if api.is_connected_to_emu():
+                    api.disconnect_from_emu()
+                api.select_family(key[0])
+            except APIError:
+                discard = True
+
+        with self._lock:
+            if not discard and not self._closed.is_set():
+                idle = self._idle.setdefault(key, list())
+                if self._max_idle_per_key is None or len(idle) < self._max_idle_per_key:
+                    idle.append((api, time.monotonic()))
+                    return
+
+        self._discard(api)
+
+    @contextlib.contextmanager
+    def checkout(self, device_family, jlink_arm_dll_path=None):
+        """
+        Context manager form of acquire() and release(). The API is discarded if the block raises an APIError.
+
+        @param enum, str or int device_family: Device family of the API.
+        @param (optional) str jlink_arm_dll_path: Absolute path to the JLinkARM DLL, see LowLevel.API.
+        """
+        api = self.acquire(device_family, jlink_arm_dll_path)
+        discard = False
+        try:
+            yield api
+        except APIError:
+            discard = True
+            raise
+        finally:
+            self.release(api, discard)
+
+    def reap(self, max_idle=None):
+        """
+        Closes the instances idle for longer than max_idle seconds.
+
+        @param (optional) float max_idle: Idle time limit in seconds. Defaults to the max_idle of the pool, 0 closes all idle instances.
+        @return int: Number of instances closed.
+        """
+        max_idle = self._max_idle if max_idle is None else max_idle
+        if max_idle is None:
+            return 0
+
+        deadline = time.monotonic() - max_idle
+        expired = list()
+        with self._lock:
+            for key, idle in self._idle.items():
+                # Instances are appended as they are returned, so the oldest ones are first.
+                count = 0
+                while count < len(idle) and idle[count][1] <= deadline:
+                    count += 1
+                expired.extend(api for api, _ in idle[:count])
+                del idle[:count]
+
+        for api in expired:
+            self._discard(api)
+        return len(expired)
+
+    def _reap_loop(self):
+        interval = min(self._max_idle, 1.0)
+        while not self._closed.wait(interval):
+            self.reap()
+
+    def idle_count(self):
+        """
+        @return int: Number of idle instances in the pool.
+        """
+        with self._lock:
+            return sum(len(idle) for idle in self._idle.values())
+
+    def close(self):
+        """
+        Closes all idle instances. Instances still checked out are closed when they are released.
+        """
+        self._closed.set()
+        if self._reaper is not None and self._reaper is not threading.current_thread():
+            self._reaper.join()
+        self.reap(0)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, ex_type, ex_value, traceback):
+        self.close()
@@ -0,0 +1,444 @@
+"""
+This module compiles firmware images into flash plans, and loads them.
+
+A flash plan is an image laid out in the flash pages of a device family, ready to be written page by page. It holds:
+    - The memories of the target that the image uses, with the memory descriptor IDs reported by read_memory_descriptors().
+    - A page table with the address, size, CRC32 and SHA-256 of every page that holds image data. Memories that are not
+      paged flash, such as RAM, have an entry per contiguous block of image data instead.
+    - The page data. Flash pages are padded with the erased flash value 0xFF, blocks are not padded.
+
+The plan is memory mapped when loaded, so loading only parses the tables, and the same plan can be programmed into many
+devices without parsing the image or hashing pages again. program_delta() uses the page hashes to only erase and write the
+pages whose content differs from what is already on the device.
+
+Compile a plan from the command line with a device connected, to read its memory layout:
+    python -m pynrfjprog.FlashPlan --family NRF52 image.hex image.plan
+"""
+
+from __future__ import print_function
+
+import argparse
+import bisect
+import collections
+import hashlib
+import mmap
+import os
+import struct
+import zlib
+
+try:
+    from . import Hex
+    from . import HighLevel
+    from . import LowLevel
+    from .Parameters import *
+except Exception:
+    import Hex
+    import HighLevel
+    import LowLevel
+    from Parameters import *
+
+
+PLAN_MAGIC = b'NRFPLAN\0'
+PLAN_VERSION = 1
+ERASED_VALUE = 0xFF
+
+# Header: magic, version, memory count, page count, data offset, sha256 of the source image.
+_HEADER = struct.Struct('<8sIIIQ32s')
+# Memory entry: descriptor id, memory type, start address, size, label.
+_MEMORY_ENTRY = struct.Struct('<IIII32s')
+# Page entry: address, size, index of the memory in the memory table, crc32, data offset, sha256.
+_PAGE_ENTRY = struct.Struct('<IIIIQ32s')
+_DATA_ALIGNMENT = 4096
+
+PlanMemory = collections.namedtuple('PlanMemory', ['id', 'type', 'start', 'size', 'label'])
+
+
+class PlanPage(object):
+    """ One flash page, or one block of image data in another memory, of a flash plan. data is a read-only memoryview into the plan file. """
+
+    __slots__ = ('address', 'size', 'memory', 'crc32', 'sha256', 'data')
+
+    def __init__(self, address, size, memory, crc32, sha256, data):
+        self.address = address
+        self.size = size
+        self.memory = memory
+        self.crc32 = crc32
+        self.sha256 = sha256
+        self.data = data
+
+    def __repr__(self):
+        return "PlanPage({:#010x}, {}, {}, {:#010x})".format(self.address, self.size, self.memory.label, self.crc32)
+
+
+def read_image(image_path, bin_address=0):
+    """
+    Reads the loadable data of a firmware image.
+
+    @param str image_path: Path to a .hex, .elf or .bin file.
+    @param (optional) int bin_address: Target address of the first byte of a .bin file.
+    @return [(int, bytes)]: List of (address, data) blocks.
+    """
+    extension = os.path.splitext(str(image_path))[1].lower()
+
+    if extension == '.hex':
+        return [(segment.address, bytes(segment.data)) for segment in Hex.Hex(str(image_path))]
+    elif extension == '.bin':
+        with open(str(image_path), 'rb') as image:
+            return [(bin_address, image.read())]
+    elif extension == '.elf':
+        return _read_elf(image_path)
+    else:
+        raise ValueError('Unsupported image file type {}. Supported file types are .hex, .elf and .bin.'.format(extension))
+
+
+def _read_elf(image_path):
+    """ Reads the PT_LOAD segments of an ELF file, placed at their physical (load) addresses. """
+    with open(str(image_path), 'rb') as image:
+        elf = image.read()
+
+    if elf[0:4] != b'\x7fELF':
+        raise ValueError('File {} is not an ELF file.'.format(image_path))
+
+    elf_class, elf_data = elf[4], elf[5]
+    endian = '<' if elf_data == 1 else '>'
+    if elf_class == 1:
+        phoff, = struct.unpack_from(endian + 'I', elf, 28)
+        phentsize, phnum = struct.unpack_from(endian + 'HH', elf, 42)
+        program_header = struct.Struct(endian + 'IIIIIIII')
+    elif elf_class == 2:
+        phoff, = struct.unpack_from(endian + 'Q', elf, 32)
+        phentsize, phnum = struct.unpack_from(endian + 'HH', elf, 54)
+        program_header = struct.Struct(endian + 'IIQQQQQQ')
+    else:
+        raise ValueError('File {} has an unknown ELF class.'.format(image_path))
+
+    blocks = list()
+    for index in range(phnum):
+        fields = program_header.unpack_from(elf, phoff + index * phentsize)
+        if elf_class == 1:
+            p_type, p_offset, p_vaddr, p_paddr, p_filesz = fields[0:5]
+        else:
+            p_type, p_offset, p_vaddr, p_paddr, p_filesz = fields[0], fields[2], fields[3], fields[4], fields[5]
+
+        # PT_LOAD segments with file content. The remainder up to p_memsz is .bss, which is not programmed.
+        if p_type == 1 and p_filesz > 0:
+            blocks.append((p_paddr, elf[p_offset:p_offset + p_filesz]))
+
+    return blocks
+
+
+# Memory types whose pages are padded with ERASED_VALUE, and erased before they are written.
+_FLASH_MEMORY_TYPES = (MemoryType.CODE, MemoryType.UICR)
+
+
+def _page_layout(memory_description):
+    """ Returns the start address of every page of a memory, and the address of the end of the memory. """
+    page_starts = list()
+    address = memory_description.start
+
+    for page_repetition in memory_description.page_repetitions:
+        for _ in range(page_repetition.num_repeats):
+            page_starts.append(address)
+            address += page_repetition.size
+
+    return page_starts, address
+
+
+def compile_plan(image_path, memory_descriptions, plan_path, bin_address=0):
+    """
+    Compiles a firmware image into a flash plan file.
+    Flash pages touched by the image are stored whole, padded with ERASED_VALUE. Other memories, such as RAM, are not
+    paged: the image data in them is stored as contiguous blocks, so that programming the plan leaves the rest untouched.
+
+    @param str image_path: Path to a .hex, .elf or .bin file.
+    @param [MemoryDescription] memory_descriptions: Memories of the target, as returned by LowLevel.API.read_memory_descriptors(read_page_sizes=True).
+    @param str plan_path: Path of the plan file to write.
+    @param (optional) int bin_address: Target address of the first byte of a .bin file.
+    @return int: Number of pages and blocks in the plan.
+    """
+    for memory_description in memory_descriptions:
+        if not is_right_class(memory_description, MemoryDescription):
+            raise ValueError('Parameter memory_descriptions must be a list of MemoryDescription.')
+        if memory_description.page_repetitions is None:
+            raise ValueError('Memory descriptions must include page sizes, see read_memory_descriptors(read_page_sizes=True).')
+
+    # (memory description, page starts, memory end). Memories that are not paged flash have no page starts.
+    layouts = list()
+    for memory_description in memory_descriptions:
+        if memory_description.type in _FLASH_MEMORY_TYPES and memory_description.page_repetitions:
+            layouts.append((memory_description,) + _page_layout(memory_description))
+        else:
+            layouts.append((memory_description, None, memory_description.start + memory_description.size))
+
+    with open(str(image_path), 'rb') as image:
+        image_sha256 = hashlib.sha256(image.read()).digest()
+
+    # Overlay the image on the pages it touches, and gather the blocks of the other memories. Both are keyed by start
+    # address, with (memory index, data) values.
+    pages = dict()
+    # Start address of the block of a memory that is not paged flash, keyed by its end address, to extend it.
+    block_ends = dict()
+    for address, data in read_image(image_path, bin_address):
+        data = memoryview(data)
+        while len(data) > 0:
+            for memory_index, (memory_description, page_starts, memory_end) in enumerate(layouts):
+                if memory_description.start <= address < memory_end:
+                    break
+            else:
+                raise ValueError('Image data at address {:#010x} is outside of the memories of the target.'.format(address))
+
+            if page_starts is None:
+                if memory_description.type in _FLASH_MEMORY_TYPES:
+                    raise ValueError('Flash memory {} has no pages.'.format(memory_description.label))
+
+                length = min(len(data), memory_end - address)
+                block_start = block_ends.pop(address, address)
+                if block_start not in pages:
+                    pages[block_start] = (memory_index, bytearray())
+                pages[block_start][1].extend(data[:length])
+                block_ends[address + length] = block_start
+            else:
+                page_index = bisect.bisect_right(page_starts, address) - 1
+                page_start = page_starts[page_index]
+                page_end = page_starts[page_index + 1] if page_index + 1 < len(page_starts) else memory_end
+
+                if page_start not in pages:
+                    pages[page_start] = (memory_index, bytearray([ERASED_VALUE]) * (page_end - page_start))
+
+                length = min(len(data), page_end - address)
+                pages[page_start][1][address - page_start:address - page_start + length] = data[:length]
+
+            data = data[length:]
+            address += length
+
+    # Only memories that hold pages are stored in the plan.
+    used_memories = sorted(set(memory_index for memory_index, page in pages.values()))
+    memory_table_index = dict((memory_index, table_index) for table_index, memory_index in enumerate(used_memories))
+
+    keys = sorted(pages)
+    tables_size = _HEADER.size + len(used_memories) * _MEMORY_ENTRY.size + len(keys) * _PAGE_ENTRY.size
+    data_offset = (tables_size + _DATA_ALIGNMENT - 1) // _DATA_ALIGNMENT * _DATA_ALIGNMENT
+
+    with open(str(plan_path), 'wb') as plan:
+        plan.write(_HEADER.pack(PLAN_MAGIC, PLAN_VERSION, len(used_memories), len(keys), data_offset, image_sha256))
+
+        for memory_index in used_memories:
+            memory_description = layouts[memory_index][0]
+            plan.write(_MEMORY_ENTRY.pack(memory_description._id, memory_description.type, memory_description.start,
+                                          memory_description.size, memory_description.label.encode('utf-8')[:32]))
+
+        offset = data_offset
+        for address in keys:
+            memory_index, page = pages[address]
+            plan.write(_PAGE_ENTRY.pack(address, len(page), memory_table_index[memory_index],
+                                        zlib.crc32(page) & 0xFFFFFFFF, offset, hashlib.sha256(page).digest()))
+            offset += len(page)
+
+        plan.write(b'\0' * (data_offset - tables_size))
+        for address in keys:
+            plan.write(pages[address][1])
+
+    return len(keys)
+
+
+class FlashPlan(object):
+    """
+    A flash plan loaded from file.
+
+    The file is memory mapped; page data is read from the file only when it is accessed.
+    """
+
+    def __init__(self, plan_path):
+        """
+        Constructor. Loads the plan at plan_path.
+
+        @param str plan_path: Path to a plan file made by compile_plan().
+        """
+        with open(str(plan_path), 'rb') as plan:
+            self._map = mmap.mmap(plan.fileno(), 0, access=mmap.ACCESS_READ)
+
+        try:
+            self._view = memoryview(self._map)
+
+            magic, version, memory_count, page_count, data_offset, self.image_sha256 = _HEADER.unpack_from(self._view, 0)
+            if magic != PLAN_MAGIC:
+                raise ValueError('File {} is not a flash plan.'.format(plan_path))
+            if version != PLAN_VERSION:
+                raise ValueError('Flash plan version {} is not supported.'.format(version))
+
+            offset = _HEADER.size
+            self.memories = list()
+            for memory_id, memory_type, start, size, label in _MEMORY_ENTRY.iter_unpack(self._view[offset:offset + memory_count * _MEMORY_ENTRY.size]):
+                self.memories.append(PlanMemory(memory_id, MemoryType(memory_type), start, size, decode_string(label.rstrip(b'\0'))))
+
+            offset += memory_count * _MEMORY_ENTRY.size
+            self.pages = list()
+            for address, size, memory_index, crc32, page_offset, sha256 in _PAGE_ENTRY.iter_unpack(self._view[offset:offset + page_count * _PAGE_ENTRY.size]):
+                self.pages.append(PlanPage(address, size, self.memories[memory_index], crc32, sha256, self._view[page_offset:page_offset + size]))
+        except Exception:
+            self.close()
+            raise
+
+    def close(self):
+        """
+        Releases the file mapping. Page data must not be used after the plan is closed.
+        """
+        for page in getattr(self, 'pages', list()):
+            page.data.release()
+        if getattr(self, '_view', None) is not None:
+            self._view.release()
+        self._map.close()
+
+    def size(self):
+        """
+        @return int: Number of data bytes in the plan.
+        """
+        return sum(page.size for page in self.pages)
+
+    def __iter__(self):
+        return iter(self.pages)
+
+    def __len__(self):
+        return len(self.pages)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, ex_type, ex_value, traceback):
+        self.close()
+
+
+def load_plan(plan_path):
+    """
+    Loads a flash plan.
+
+    @param str plan_path: Path to a plan file made by compile_plan().
+    @return FlashPlan: The loaded plan.
+    """
+    return FlashPlan(plan_path)
+
+
+class DeltaReport(object):
+    """ Result of a program_delta() operation. """
+
+    def __init__(self):
+        self.pages_total = 0
+        self.pages_skipped = 0
+        self.pages_erased = 0
+        self.pages_written = 0
+        self.bytes_total = 0
+        self.bytes_saved = 0
+
+    def __repr__(self):
+        return "DeltaReport({} of {} pages skipped, {} erased, {} written, {} of {} bytes saved)".format(
+            self.pages_skipped,
+            self.pages_total,
+            self.pages_erased,
+            self.pages_written,
+            self.bytes_saved,
+            self.bytes_total
+        )
+
+
+# Memory types that program_delta() can write.
+_DELTA_MEMORY_TYPES = (MemoryType.CODE, MemoryType.UICR, MemoryType.DATA_RAM, MemoryType.CODE_RAM)
+
+
+def _needs_erase(current, target):
+    """ Flash bits can only be programmed from 1 to 0 without an erase. """
+    target = int.from_bytes(target, 'little')
+    return int.from_bytes(current, 'little') & target != target
+
+
+def program_delta(target, plan):
+    """
+    Programs a flash plan, skipping the pages whose content already matches the device.
+
+    Each page of the plan is read back from the device and its SHA-256 is compared with the hash stored in the plan.
+    Pages that differ are written, and erased first if the new content can not be programmed over the current content.
+    Flash page data is padded with 0xFF, so data outside of the image in a rewritten flash page is erased. Blocks in RAM
+    only cover the image data, and the rest of the RAM is neither compared nor written.
+
+    @param LowLevel.API or HighLevel.DebugProbe target: Opened API connected to the device, or an initialized debug probe.
+    @param FlashPlan or str plan: Flash plan, or path to a plan file made by compile_plan().
+    @return DeltaReport: Number of pages and bytes skipped.
+    """
+    if not isinstance(target, (LowLevel.API, HighLevel.DebugProbe)):
+        raise TypeError('The target parameter must be an instance of LowLevel.API or HighLevel.DebugProbe.')
+
+    if not isinstance(plan, FlashPlan):
+        with load_plan(plan) as loaded_plan:
+            return program_delta(target, loaded_plan)
+
+    # Validate the whole plan first, so that an unsupported page does not leave the device half programmed.
+    for page in plan.pages:
+        if page.memory.type not in _DELTA_MEMORY_TYPES:
+            raise ValueError('Delta programming of {} memory is not supported.'.format(page.memory.type.name))
+
+    report = DeltaReport()
+    buffer = bytearray(max([page.size for page in plan.pages] + [0]))
+
+    for page in plan.pages:
+        report.pages_total += 1
+        report.bytes_total += page.size
+
+        current = memoryview(buffer)[:page.size]
+        target.read_into(page.address, current)
+        if hashlib.sha256(current).digest() == page.sha256:
+            report.pages_skipped += 1
+            report.bytes_saved += page.size
+            continue
+
+        erase = page.memory.type in _FLASH_MEMORY_TYPES and _needs_erase(current, page.data)
+
+        if erase:
+            report.pages_erased += 1
+            if isinstance(target, LowLevel.API):
+                if page.memory.type == MemoryType.UICR:
+                    target.erase_uicr()
+                else:
+                    target.erase_page(page.address)
+            elif page.memory.type == MemoryType.UICR:
+                target.erase(EraseAction.ERASE_SECTOR_AND_UICR, page.address, page.address + page.size - 1)
+            else:
+                target.erase(EraseAction.ERASE_SECTOR, page.address, page.address + page.size - 1)
+
+        report.pages_written += 1
+        if isinstance(target, LowLevel.API):
+            target.write(page.address, page.data, page.memory.type in _FLASH_MEMORY_TYPES)
+        else:
+            target.write(page.address, page.data)
+
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile a .hex, .elf or .bin image into a flash plan for a connected device.')
+    parser.add_argument('image', help='Image file to compile.')
+    parser.add_argument('plan', help='Flash plan file to write.')
+    parser.add_argument('-f', '--family', default='UNKNOWN', help='Device family of the target.')
+    parser.add_argument('-s', '--snr', type=int, help='Serial number of the debug probe connected to the target.')
+    parser.add_argument('--coprocessor', help='Coprocessor whose memories are used.')
+    parser.add_argument('--bin-address', type=lambda value: int(value, 0), default=0, help='Target address of a .bin image.')
+    args = parser.parse_args()
+
+    with LowLevel.API(args.family) as api:
+        if args.snr is not None:
+            api.connect_to_emu_with_snr(args.snr)
+        else:
+            api.connect_to_emu_without_snr()
+
+        if args.family.upper() == 'UNKNOWN':
+            api.select_family(api.read_device_family())
+        if args.coprocessor is not None:
+            api.select_coprocessor(args.coprocessor)
+
+        memory_descriptions = api.read_memory_descriptors()
+        api.disconnect_from_emu()
+
+    page_count = compile_plan(args.image, memory_descriptions, args.plan, args.bin_address)
+    print('Wrote {} pages to {}.'.format(page_count, args.plan))
+
+
+if __name__ == '__main__':
+    main()
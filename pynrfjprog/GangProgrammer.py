@@ -0,0 +1,172 @@
+"""
+This module programs many devices in parallel through the HighLevel API.
+
+One HighLevel.DebugProbe is opened per serial number, and jobs run on a bounded thread pool. The DLL calls made through
+ctypes release the GIL, so probes on separate USB connections are programmed concurrently.
+
+Example:
+    with HighLevel.API() as api:
+        with GangProgrammer.GangProgrammer(api) as gang:
+            for result in gang.program('image.hex', verify_action=HighLevel.VerifyAction.VERIFY_READ):
+                print(result)
+"""
+
+from __future__ import print_function
+
+import concurrent.futures
+import threading
+import time
+
+try:
+    from . import HighLevel
+    from .APIError import *
+    from .Parameters import *
+except Exception:
+    import HighLevel
+    from APIError import *
+    from Parameters import *
+
+
+class ProbeResult(object):
+    """ Result of a job on one probe. """
+
+    def __init__(self, serial_number):
+        self.serial_number = serial_number
+        self.error = None
+        # Duration in seconds of each completed step, in the order they ran.
+        self.timings = list()
+        self.elapsed = 0.0
+
+    @property
+    def success(self):
+        return self.error is None
+
+    def __repr__(self):
+        return "ProbeResult({}, {}, {:.3f}s, [{}])".format(
+            self.serial_number,
+            "OK" if self.success else repr(self.error),
+            self.elapsed,
+            ", ".join("{} {:.3f}s".format(step, duration) for step, duration in self.timings)
+        )
+
+
+class GangProgrammer(object):
+    """
+    Runs the same job on many debug probes in parallel.
+    Probes are opened on first use and kept open until close() is called, so repeated jobs do not pay the probe initialization time.
+    """
+
+    def __init__(self, api, serial_numbers=None, max_workers=None, coprocessor=None, jlink_arm_dll_path=None, log=False, clock_speed=None):
+        """
+        Constructor.
+
+        @param HighLevel.API api: Opened HighLevel API to create the probes from.
+        @param (optional) [int] serial_numbers: Serial numbers of the probes to use. By default all connected probes are used.
+        @param (optional) int max_workers: Maximum number of probes operated at the same time. By default all probes run at the same time.
+        @param (optional) CoProcessor coprocessor: Coprocessor to connect to, see HighLevel.DebugProbe.
+        @param (optional) str jlink_arm_dll_path: Path to the JLinkARM DLL, see HighLevel.DebugProbe.
+        @param (optional) bool log: Enables info and debug log messages of the probes, see HighLevel.DebugProbe.
+        @param (optional) int clock_speed: SWD clock speed in kHz, see HighLevel.DebugProbe.
+        """
+        if not isinstance(api, HighLevel.API):
+            raise TypeError('The api parameter must be an instance of HighLevel.API.')
+
+        if serial_numbers is None:
+            serial_numbers = api.get_connected_probes()
+
+        for serial_number in serial_numbers:
+            if not is_u32(serial_number):
+                raise ValueError('The serial_numbers parameter must be a list of unsigned 32-bit values.')
+
+        if max_workers is not None and (not isinstance(max_workers, int) or max_workers < 1):
+            raise ValueError('The max_workers parameter must be a positive integer.')
+
+        self._api = api
+        self._serial_numbers = list(serial_numbers)
+        self._probe_args = dict(coprocessor=coprocessor, jlink_arm_dll_path=jlink_arm_dll_path, log=log, clock_speed=clock_speed)
+        self._probes = dict()
+        self._probes_lock = threading.Lock()
+        self._executor = concurrent.futures.ThreadPoolExecutor(max_workers=max_workers or max(1, len(self._serial_numbers)))
+
+    @property
+    def serial_numbers(self):
+        return list(self._serial_numbers)
+
+    def _get_probe(self, serial_number):
+        with self._probes_lock:
+            probe = self._probes.get(serial_number)
+        if probe is None:
+            probe = HighLevel.DebugProbe(self._api, serial_number, **self._probe_args)
+            with self._probes_lock:
+                self._probes[serial_number] = probe
+        return probe
+
+    def _run_job(self, serial_number, steps):
+        result = ProbeResult(serial_number)
+        job_start = time.perf_counter()
+        try:
+            step_start = time.perf_counter()
+            probe = self._get_probe(serial_number)
+            result.timings.append(('open', time.perf_counter() - step_start))
+
+            for name, function in steps:
+                step_start = time.perf_counter()
+                function(probe)
+                result.timings.append((name, time.perf_counter() - step_start))
+        except Exception as error:
+            # Recorded in the result of this probe only, so that the jobs of the other probes complete.
+            result.error = error
+        result.elapsed = time.perf_counter() - job_start
+        return result
+
+    def run(self, steps):
+        """
+        Runs a custom job on every probe.
+
+        @param [(str, callable)] steps: Named steps of the job. Each callable receives the HighLevel.DebugProbe of the probe being processed.
+        @return [ProbeResult]: One result per probe, in the order of the serial numbers. A job stops at the first failing step.
+        """
+        futures = [self._executor.submit(self._run_job, serial_number, steps) for serial_number in self._serial_numbers]
+        return [future.result() for future in futures]
+
+    def program(self, hex_path, program_options=None, verify_action=HighLevel.VerifyAction.VERIFY_NONE, reset_action=HighLevel.ResetAction.RESET_NONE):
+        """
+        Programs, then optionally verifies and resets, every probe.
+
+        @param str hex_path: Path to the file to program.
+        @param (optional) ProgramOptions program_options: Programming options, see HighLevel.Probe.program.
+        @param (optional) VerifyAction verify_action: If not VERIFY_NONE, verify the file after programming.
+        @param (optional) ResetAction reset_action: If not RESET_NONE, reset the device after programming and verifying.
+        @return [ProbeResult]: One result per probe, in the order of the serial numbers.
+        """
+        if program_options is not None and not isinstance(program_options, HighLevel.ProgramOptions):
+            raise TypeError('The program_options parameter must be an instance of class ProgramOptions.')
+        if not isinstance(verify_action, HighLevel.VerifyAction):
+            raise TypeError('Parameter verify_action must be of type VerifyAction enumeration.')
+        if not isinstance(reset_action, HighLevel.ResetAction):
+            raise TypeError('Parameter reset_action must be of type ResetAction enumeration.')
+
+        steps = [('program', lambda probe: probe.program(hex_path, program_options))]
+        if verify_action != HighLevel.VerifyAction.VERIFY_NONE:
+            steps.append(('verify', lambda probe: probe.verify(hex_path, verify_action)))
+        if reset_action != HighLevel.ResetAction.RESET_NONE:
+            steps.append(('reset', lambda probe: probe.reset(reset_action)))
+
+        return self.run(steps)
+
+    def close(self):
+        """
+        Waits for running jobs, then closes all probes.
+        """
+        self._executor.shutdown(wait=True)
+        with self._probes_lock:
+            probes = list(self._probes.values())
+            self._probes.clear()
+        for probe in probes:
+            probe.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, ex_type, ex_value, traceback):
+        self.close()
@@ -3,6 +3,9 @@ Deprecated: This module will not be supported in the future and should not be us
 """
 
 from builtins import int
+import binascii
+import mmap
+import os
 import sys
 
 py2 = sys.version_info[0] == 2
@@ -14,77 +17,121 @@ class Segment(object):
 
     def __init__(self, addr, vals):
         self.address = addr
-        self.data = vals
-        self.length = len(vals)
+        self.data = bytearray(vals)
+        self.length = len(self.data)
 
     def append(self, vals):
         self.data.extend(vals)
-        self.length += len(vals)
+        self.length = len(self.data)
+
+    @property
+    def view(self):
+        """ Memoryview of the segment data. The segment can not be appended to while the view is in use. """
+        return memoryview(self.data)
+
+
+class Chunk(object):
+    """
+    Memory chunk yielded by iter_hex_chunks() and iter_bin_chunks(), for use with API.write() method.
+    Has the same address, data and length attributes as Segment.
+    """
+
+    def __init__(self, addr, data):
+        self.address = addr
+        self.data = data
+        self.length = len(data)
 
 
 class Hex(object):
     """Parsed hex file."""
 
+    DATA_RECORD = 0x00
+    END_OF_FILE_RECORD = 0x01
+    EXTENDED_SEGMENT_ADDRESS_RECORD = 0x02
+    START_SEGMENT_ADDRESS_RECORD = 0x03
+    EXTENDED_LINEAR_ADDRESS_RECORD = 0x04
+    START_LINEAR_ADDRESS_RECORD = 0x05
+
     def __init__(self, filename):
 
         self._segment_list = []
         self._high_address = 0
 
+        # Entry point given by record types 03 (CS, IP) and 05 (EIP), if present in the file.
+        self.start_segment_address = None
+        self.start_linear_address = None
+
         with open(filename, 'r', 1) as file:
             
             high_address_changed = False
-            for line in file:
+            for line_number, line in enumerate(file, 1):
 
-                record_data_length, record_address, record_type, record_data, record_checksum = self._intel_hex_recored_parse(line)
-                if record_type == "extended_linear_address_record":
-                    self._high_address = record_data[0] * 0x1000000 + record_data[1] * 0x10000
-                    high_address_changed = True # Set this to true so that a new segment is added for the next line
-                elif record_type == "extended_segment_address_record":
-                    self._high_address = ((record_data[0] << 8) | record_data[1]) * 16
-                    high_address_changed = True
-                elif record_type == "data_record":
+                record = self._intel_hex_record_decode(line, line_number)
+                if record is None:
+                    continue
+
+                record_type = record[3]
+                record_data = record[4:-1]
+                if record_type == self.DATA_RECORD:
+                    record_full_address = self._high_address + ((record[1] << 8) | record[2])
                     # Check if segment_list is empty
                     if (len(self._segment_list) == 0 or high_address_changed):
-                        self._segment_list.append(Segment(self._high_address + record_address, record_data))
+                        self._segment_list.append(Segment(record_full_address, record_data))
                         high_address_changed = False # Set to false so next lines are check for appending
                     else:
                         # Check if data_record is the next address in current segment
                         current_segment = self._segment_list[-1]
-                        record_full_address = self._high_address + record_address
                         if ( ( current_segment.address + current_segment.length ) == record_full_address ) :
                             # Append line to current segment
                             current_segment.append(record_data)
                         else:
                             # Add new segment
-                            self._segment_list.append(Segment(self._high_address + record_address, record_data))
-                else:
-                    #implement more if desired or necessary
-                    pass
-
-    def _intel_hex_recored_parse(self, line):
-
-        record_data_length = int(line[1:3], 16)
-
-        record_address = int(line[3:7], 16)
-
-        if line[7:9] == '00':
-            record_type = "data_record"
-        elif line[7:9] == '02':
-            record_type = "extended_segment_address_record"
-        elif line[7:9] == '04':
-            record_type = "extended_linear_address_record"
-        else:
-            # implement more if desired or necessary
-            record_type = "other"
-
-        record_data = []
-        for i in range(record_data_length):
-            record_data.append(int(line[9+i*2:11+i*2], 16))
-
-        record_checksum = int(line[9+record_data_length*2:11+record_data_length*2], 16)
-
-        return record_data_length, record_address, record_type, record_data, record_checksum
-
+                            self._segment_list.append(Segment(record_full_address, record_data))
+                elif record_type == self.EXTENDED_LINEAR_ADDRESS_RECORD:
+                    self._high_address = record_data[0] * 0x1000000 + record_data[1] * 0x10000
+                    high_address_changed = True # Set this to true so that a new segment is added for the next line
+                elif record_type == self.EXTENDED_SEGMENT_ADDRESS_RECORD:
+                    self._high_address = ((record_data[0] << 8) | record_data[1]) * 16
+                    high_address_changed = True
+                elif record_type == self.START_SEGMENT_ADDRESS_RECORD:
+                    self.start_segment_address = ((record_data[0] << 8) | record_data[1], (record_data[2] << 8) | record_data[3])
+                elif record_type == self.START_LINEAR_ADDRESS_RECORD:
+                    self.start_linear_address = int.from_bytes(record_data, 'big')
+                elif record_type == self.END_OF_FILE_RECORD:
+                    break
+
+    @staticmethod
+    def _intel_hex_record_decode(line, line_number):
+        """
+        Decodes one line of the hex file into the raw bytes of its record, and validates length and checksum.
+
+        @param str or bytes line: Line of the hex file.
+        @param int line_number: Line number, used in error messages.
+        @return bytes or None: Record bytes, from the byte count field to the checksum field. None for blank lines.
+        """
+        line = line.strip()
+        if not line:
+            return None
+
+        if line[:1] not in (':', b':'):
+            raise ValueError('Line {} of hex file does not start with a record mark.'.format(line_number))
+
+        try:
+            record = binascii.unhexlify(line[1:])
+        except ValueError:
+            raise ValueError('Line {} of hex file contains invalid hex digits.'.format(line_number))
+
+        if len(record) < 5 or len(record) != record[0] + 5:
+            raise ValueError('Line {} of hex file has an invalid record length.'.format(line_number))
+
+        if sum(record) & 0xFF != 0:
+            raise ValueError('Line {} of hex file has an invalid checksum.'.format(line_number))
+
+        if record[3] in (Hex.EXTENDED_SEGMENT_ADDRESS_RECORD, Hex.EXTENDED_LINEAR_ADDRESS_RECORD) and record[0] != 2 or \
+                record[3] in (Hex.START_SEGMENT_ADDRESS_RECORD, Hex.START_LINEAR_ADDRESS_RECORD) and record[0] != 4:
+            raise ValueError('Line {} of hex file has an invalid record length.'.format(line_number))
+
+        return record
 
     def __iter__(self):
         self._iter_index = 0
@@ -109,3 +156,95 @@ class Hex(object):
 
             self._iter_index = self._iter_index + 1
             return self._segment_list[self._iter_index - 1]
+
+
+def iter_hex_chunks(filename, chunk_size=4096):
+    """
+    Streams a hex file without loading all of its records in memory.
+
+    The file is memory mapped and decoded lazily, one record at a time. Consecutive data is gathered into chunks that never
+    cross a chunk_size aligned boundary, so with chunk_size set to the flash page size each chunk fits in one page.
+    Memory use is bounded by chunk_size regardless of the size of the file.
+
+    @param str filename: Path to the hex file.
+    @param (optional) int chunk_size: Alignment and maximum size of the chunks in bytes.
+    @return generator of Chunk: Chunks in file order. Chunk data is a bytearray owned by the caller.
+    """
+    if chunk_size <= 0:
+        raise ValueError('The chunk_size parameter must be a positive integer.')
+
+    with open(filename, 'rb') as file:
+        if os.fstat(file.fileno()).st_size == 0:
+            return
+
+        with mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ) as hex_map:
+            high_address = 0
+            chunk_address = 0
+            chunk = bytearray()
+
+            for line_number, line in enumerate(iter(hex_map.readline, b''), 1):
+                record = Hex._intel_hex_record_decode(line, line_number)
+                if record is None:
+                    continue
+
+                record_type = record[3]
+                if record_type == Hex.DATA_RECORD:
+                    address = high_address + ((record[1] << 8) | record[2])
+                    record_data = memoryview(record)[4:-1]
+
+                    while len(record_data) > 0:
+                        if len(chunk) > 0 and address != chunk_address + len(chunk):
+                            yield Chunk(chunk_address, chunk)
+                            chunk = bytearray()
+                        if len(chunk) == 0:
+                            chunk_address = address
+
+                        # Fill the chunk up to the next chunk_size boundary
+                        length = min(len(record_data), chunk_size - (address % chunk_size))
+                        chunk += record_data[:length]
+                        record_data = record_data[length:]
+                        address += length
+
+                        if address % chunk_size == 0:
+                            yield Chunk(chunk_address, chunk)
+                            chunk = bytearray()
+
+                elif record_type == Hex.EXTENDED_LINEAR_ADDRESS_RECORD:
+                    high_address = ((record[4] << 8) | record[5]) << 16
+                elif record_type == Hex.EXTENDED_SEGMENT_ADDRESS_RECORD:
+                    high_address = ((record[4] << 8) | record[5]) * 16
+                elif record_type == Hex.END_OF_FILE_RECORD:
+                    break
+
+            if len(chunk) > 0:
+                yield Chunk(chunk_address, chunk)
+
+
+def iter_bin_chunks(filename, address=0, chunk_size=4096):
+    """
+    Streams a binary image file without reading it in memory.
+
+    The file is memory mapped and returned in chunks that never cross a chunk_size aligned boundary of the target address space.
+    Chunk data is a read-only memoryview into the mapped file, so no data is copied until it is passed to the DLL.
+    A chunk's data is released when the next chunk is requested, and must not be used after that.
+
+    @param str filename: Path to the binary file.
+    @param (optional) int address: Target address of the first byte of the file.
+    @param (optional) int chunk_size: Alignment and maximum size of the chunks in bytes.
+    @return generator of Chunk: Chunks in address order.
+    """
+    if chunk_size <= 0:
+        raise ValueError('The chunk_size parameter must be a positive integer.')
+
+    with open(filename, 'rb') as file:
+        if os.fstat(file.fileno()).st_size == 0:
+            return
+
+        with mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ) as bin_map:
+            with memoryview(bin_map) as bin_view:
+                offset = 0
+                while offset < len(bin_view):
+                    length = min(len(bin_view) - offset, chunk_size - ((address + offset) % chunk_size))
+                    with bin_view[offset:offset + length] as chunk_view:
+                        yield Chunk(address + offset, chunk_view)
+                    offset += length
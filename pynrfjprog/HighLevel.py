@@ -15,6 +15,9 @@ from pathlib import Path
 
 from .APIError import *
 from .Parameters import *
+from . import Instrumentation
+from . import Progress
+from . import Trace
 
 """
 Logging:
@@ -43,16 +46,38 @@ class API(object):
     # List of generated probes to make sure their python objects survive to self.close() if neccessary.
     probes = list()
 
-    def __init__(self, log=True):
+    def __init__(self, log=True, trace=None):
         """
         Constructor.
 
         @param (optional) bool log: If present and true, will enable logging to the logging instance returned by logging.getLogger(logid)
+        @param (optional) str or Trace.TraceRecorder trace: If present, will record the DLL calls of the api and of the probes created afterwards as a Chrome trace_event timeline, see Trace.py. A file path is written when api.close() is called.
         """
 
         _logger = logging.getLogger(__name__)
         self._logger = Parameters.LoggerAdapter(_logger, None, log=log)
 
+        self.lib = self._load_library()
+
+        # Trace recorder created by this api for a trace file path, saved in api.close().
+        self._trace = None
+        self._trace_file_path = None
+        if isinstance(trace, Trace.TraceRecorder):
+            self.add_call_observer(trace)
+        elif trace is not None:
+            self._trace = Trace.TraceRecorder()
+            self._trace_file_path = trace
+            self.add_call_observer(self._trace)
+
+        # Make a default "dead" finalizer. We'll initialize this later.
+        self._finalizer = weakref.finalize(self, lambda: None)()
+
+    def _load_library(self):
+        """
+        Loads the highlevelnrfjprog DLL. Subclasses can override it to use another implementation, see Simulator.py.
+
+        @return: Object providing the highlevelnrfjprog functions.
+        """
         this_dir, this_file = os.path.split(__file__)
 
         if sys.maxsize > 2 ** 32:
@@ -77,13 +102,10 @@ class API(object):
             raise APIError(NrfjprogdllErr.NRFJPROG_SUB_DLL_NOT_FOUND, highlevel_nrfjprog_dll_path, log=self._logger.error)
 
         try:
-            self.lib = ctypes.cdll.LoadLibrary(highlevel_nrfjprog_dll_path)
+            return ctypes.cdll.LoadLibrary(highlevel_nrfjprog_dll_path)
         except Exception as ex:
             raise APIError(NrfjprogdllErr.NRFJPROG_SUB_DLL_COULD_NOT_BE_OPENED, 'Got error {} for library at {}'.format(repr(ex), highlevel_nrfjprog_dll_path), log=self._logger.error)
 
-        # Make a default "dead" finalizer. We'll initialize this later.
-        self._finalizer = weakref.finalize(self, lambda: None)()
-
     """
     highlevelnrfjprog DLL functions.
 
@@ -99,16 +121,12 @@ class API(object):
         minor = ctypes.c_uint32(0)
         micro = ctypes.c_uint32(0)
 
-        result = self.lib.NRFJPROG_dll_version(ctypes.byref(major), ctypes.byref(minor), ctypes.byref(micro))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self.lib.NRFJPROG_dll_version, ctypes.byref(major), ctypes.byref(minor), ctypes.byref(micro))
 
         return major.value, minor.value, micro.value
 
     def open(self):
-        result = self.lib.NRFJPROG_dll_open_ex(None, self._logger.log_cb, None)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self.lib.NRFJPROG_dll_open_ex, None, self._logger.log_cb, None)
 
         # Make sure that api is closed before api is destroyed
         self._finalizer = weakref.finalize(self, self.close)
@@ -118,6 +136,10 @@ class API(object):
 
         # List.clear is not available in Python 2.7. Manually delete all elements in list instead.
         del self.probes[:]
+        self._logger.close()
+
+        if self._trace is not None:
+            self._trace.save(self._trace_file_path)
 
         # Disable the api finalizer, as it's no longer necessary when the api is closed.
         self._finalizer.detach()
@@ -126,29 +148,60 @@ class API(object):
 
         is_opened = ctypes.c_bool(False)
 
-        result = self.lib.NRFJPROG_is_dll_open(ctypes.byref(is_opened))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self.lib.NRFJPROG_is_dll_open, ctypes.byref(is_opened))
 
         return is_opened.value
 
-    def get_errors(self):
+    def get_errors(self, since=None):
         """
         Gets last logged error messages from the nrfjprog dll.
         Used to fill in APIError messages.
 
+        @param (optional) int since: Error sequence number taken with self._logger.error_sequence() before the failing call. Defaults to the messages since the previous get_errors() call.
         @Return list of error strings.
         """
-        return self._logger.get_errors()
+        return Instrumentation.timed(self.lib, 'get_errors', self._logger.get_errors, since)
+
+    def _call(self, function, *args):
+        """
+        Calls a DLL function, and raises an APIError with the error messages the DLL reported during the call if it fails.
+
+        @param callable function: Function of self.lib.
+        """
+        since = self._logger.error_sequence()
+        result = function(*args)
+        if result != NrfjprogdllErr.SUCCESS:
+            raise APIError(result, error_data=self.get_errors(since), log=self._logger.error)
+
+    def add_call_observer(self, observer):
+        """
+        Adds an observer of the DLL calls made by this API, see Instrumentation.py.
+        The observer is also added to the probes created afterwards.
+
+        @param observer: Object with an on_call(owner, name, args, result, start, end) method.
+        """
+        self.lib = Instrumentation.add_call_observer(self.lib, self, observer)
+
+    def remove_call_observer(self, observer):
+        """
+        Removes an observer added with add_call_observer(). Probes keep the observers they were created with.
+
+        @param observer: Observer to remove.
+        """
+        self.lib = Instrumentation.remove_call_observer(self.lib, observer)
+
+    def call_observers(self):
+        """
+        @return tuple: Observers added with add_call_observer().
+        """
+        return Instrumentation.call_observers(self.lib)
 
     def get_connected_probes(self):
         serial_numbers_len = ctypes.c_uint32(127)
         serial_numbers = (ctypes.c_uint32 * serial_numbers_len.value)(0)
         num_available = ctypes.c_uint32(0)
 
-        result = self.lib.NRFJPROG_get_connected_probes(ctypes.byref(serial_numbers), serial_numbers_len, ctypes.byref(num_available))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self.lib.NRFJPROG_get_connected_probes, ctypes.byref(serial_numbers), serial_numbers_len, ctypes.byref(num_available))
 
         snr = [int(serial_numbers[i]) for i in range(0, min(num_available.value, serial_numbers_len.value))]
 
@@ -205,6 +258,11 @@ class Probe(object):
         _logger = logging.getLogger(__name__)
         self._logger = Parameters.LoggerAdapter(_logger, "Probes." + str(logger_id), log=log)
 
+        # Probes share the library of the API, without its call observers so that calls are reported with the probe as owner.
+        self._lib = Instrumentation.unwrap(api.lib)
+        for observer in api.call_observers():
+            self.add_call_observer(observer)
+
         self._api.register_probe(self)
 
         # Make sure that probe is closed before it's destroyed
@@ -226,41 +284,64 @@ class Probe(object):
 
     def close(self):
         if self._handle is not None and self._api.is_open():
-            result = self._api.lib.NRFJPROG_probe_uninit(ctypes.byref(self._handle))
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_probe_uninit, ctypes.byref(self._handle))
             self._handle = None
         self._api.deregister_probe(self)
+        self._logger.close()
 
         # Disable the probe finalizer, as it's no longer necessary when the probe is closed.
         self._finalizer.detach()
 
-    def get_errors(self):
+    def get_errors(self, since=None):
         """
         Gets last logged error messages from the nrfjprog dll.
         Used to fill in APIError messages.
 
+        @param (optional) int since: Error sequence number taken with self._logger.error_sequence() before the failing call. Defaults to the messages since the previous get_errors() call.
         @Return list of error strings.
         """
-        return self._logger.get_errors()
+        return Instrumentation.timed(self._lib, 'get_errors', self._logger.get_errors, since)
+
+    def _call(self, function, *args):
+        """
+        Calls a DLL function, and raises an APIError with the error messages the DLL reported during the call if it fails.
+
+        @param callable function: Function of self._lib.
+        """
+        since = self._logger.error_sequence()
+        result = function(*args)
+        if result != NrfjprogdllErr.SUCCESS:
+            raise APIError(result, error_data=self.get_errors(since), log=self._logger.error)
+
+    def add_call_observer(self, observer):
+        """
+        Adds an observer of the DLL calls made by this probe, see Instrumentation.py.
+
+        @param observer: Object with an on_call(owner, name, args, result, start, end) method.
+        """
+        self._lib = Instrumentation.add_call_observer(self._lib, self, observer)
+
+    def remove_call_observer(self, observer):
+        """
+        Removes an observer added with add_call_observer().
+
+        @param observer: Observer to remove.
+        """
+        self._lib = Instrumentation.remove_call_observer(self._lib, observer)
 
     def probe_reset(self):
         """
         Resets the connected debug probe.
         """
 
-        result = self._api.lib.NRFJPROG_probe_reset(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_probe_reset, self._handle)
 
     def probe_replace_fw(self):
         """
         Replace the firmware of the connected debug probe.
         """
 
-        result = self._api.lib.NRFJPROG_probe_replace_fw(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_probe_replace_fw, self._handle)
 
     def setup_qspi(self, memory_size=None, qspi_ini_params=QSPIInitParams()):
         """
@@ -276,9 +357,7 @@ class Probe(object):
 
         memory_size = ctypes.c_uint32(memory_size)
 
-        result = self._api.lib.NRFJPROG_probe_setup_qspi(self._handle, memory_size, qspi_ini_params)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_probe_setup_qspi, self._handle, memory_size, qspi_ini_params)
 
     def setup_qspi_with_ini(self, ini_path=QSPIIniFile):
         """
@@ -288,9 +367,7 @@ class Probe(object):
         """
 
         ini_path = str(ini_path).encode('utf-8')
-        result = self._api.lib.NRFJPROG_probe_setup_qspi_ini(self._handle, ini_path)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_probe_setup_qspi_ini, self._handle, ini_path)
 
     def set_coprocessor(self, coprocessor):
         """
@@ -302,38 +379,30 @@ class Probe(object):
 
         coprocessor = ctypes.c_int(decode_enum(coprocessor, CoProcessor))
 
-        result = self._api.lib.NRFJPROG_probe_set_coprocessor(self._handle, coprocessor)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_probe_set_coprocessor, self._handle, coprocessor)
 
     def get_library_info(self):
         library_info = LibraryInfoStruct(0)
-        result = self._api.lib.NRFJPROG_get_library_info(self._handle, ctypes.byref(library_info))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_get_library_info, self._handle, ctypes.byref(library_info))
 
         return LibraryInfo(library_info)
 
     def get_probe_info(self):
         probe_info = ProbeInfoStruct(0)
-        result = self._api.lib.NRFJPROG_get_probe_info(self._handle, ctypes.byref(probe_info))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_get_probe_info, self._handle, ctypes.byref(probe_info))
 
         return ProbeInfo(probe_info)
 
     def get_device_info(self):
         device_info = DeviceInfoStruct(0)
-        result = self._api.lib.NRFJPROG_get_device_info(self._handle, ctypes.byref(device_info))
+        result = self._lib.NRFJPROG_get_device_info(self._handle, ctypes.byref(device_info))
         if result != NrfjprogdllErr.SUCCESS:
             self._logger.warning("get_device_info returned returned with error {}. DeviceInfo struct will have missing information.".format(result))
         return DeviceInfo(device_info, result)
 
     def get_readback_protection(self):
         protection_status = ctypes.c_int(0)
-        result = self._api.lib.NRFJPROG_get_readback_protection(self._handle, ctypes.byref(protection_status))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_get_readback_protection, self._handle, ctypes.byref(protection_status))
 
         return ReadbackProtection(protection_status.value)
 
@@ -343,61 +412,73 @@ class Probe(object):
 
         protection_status = ctypes.c_int(decode_enum(protection_status, ReadbackProtection))
 
-        result = self._api.lib.NRFJPROG_readback_protect(self._handle, protection_status)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_readback_protect, self._handle, protection_status)
 
     def get_erase_protection(self):
         is_erase_protect = ctypes.c_bool()
-        result = self._api.lib.NRFJPROG_is_eraseprotect_enabled(self._handle, ctypes.byref(is_erase_protect))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_is_eraseprotect_enabled, self._handle, ctypes.byref(is_erase_protect))
         return is_erase_protect.value
 
     def enable_erase_protect(self):
-        result = self._api.lib.NRFJPROG_enable_eraseprotect(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_enable_eraseprotect, self._handle)
 
-    def program(self, hex_path, program_options=None):
+    def program(self, hex_path, program_options=None, progress=None):
+        """
+        Programs a file.
+
+        @param str hex_path: Path to the file to program.
+        @param (optional) ProgramOptions program_options: Programming options. Defaults to the options of the probe.
+        @param (optional) callable progress: Called with Progress.ProgressEvent objects while programming, see Progress.py.
+        """
+        file_path = hex_path
         hex_path = str(hex_path).encode('utf-8')
 
         if program_options is None:
-            result = self._api.lib.NRFJPROG_program(self._handle, hex_path, self._program_options)
-        else:
-            if not isinstance(program_options, ProgramOptions):
-                raise TypeError('The program_options parameter must be an instance of class ProgramOptions.')
+            program_options = self._program_options
+        elif not isinstance(program_options, ProgramOptions):
+            raise TypeError('The program_options parameter must be an instance of class ProgramOptions.')
 
-            result = self._api.lib.NRFJPROG_program(self._handle, hex_path, program_options)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        with Progress.track(self._logger, progress, 'program', file_path):
+            self._call(self._lib.NRFJPROG_program, self._handle, hex_path, program_options)
 
     def read_to_file(self, hex_path, read_options=None):
         hex_path = str(hex_path).encode('utf-8')
 
         if read_options is None:
-            result = self._api.lib.NRFJPROG_read_to_file(self._handle, hex_path, self._read_options)
-        else:
-            if not isinstance(read_options, ReadOptions):
-                raise TypeError('The program_options parameter must be an instance of class ProgramOptions.')
+            read_options = self._read_options
+        elif not isinstance(read_options, ReadOptions):
+            raise TypeError('The program_options parameter must be an instance of class ProgramOptions.')
 
-            result = self._api.lib.NRFJPROG_read_to_file(self._handle, hex_path, read_options)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_read_to_file, self._handle, hex_path, read_options)
 
-    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_READ):
+    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_READ, progress=None):
+        """
+        Verifies that the device contains a file.
+
+        @param str hex_path: Path to the file to verify.
+        @param (optional) VerifyAction verify_action: Verify method.
+        @param (optional) callable progress: Called with Progress.ProgressEvent objects while verifying, see Progress.py.
+        """
         if not isinstance(verify_action, VerifyAction):
             raise TypeError('Parameter verify_action must be of type int, str or VerifyAction enumeration.')
 
         verify_action = ctypes.c_int(decode_enum(verify_action, VerifyAction))
 
+        file_path = hex_path
         hex_path = str(hex_path).encode('utf-8')
 
-        result = self._api.lib.NRFJPROG_verify(self._handle, hex_path, verify_action)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        with Progress.track(self._logger, progress, 'verify', file_path):
+            self._call(self._lib.NRFJPROG_verify, self._handle, hex_path, verify_action)
+
+    def erase(self, erase_action=EraseAction.ERASE_ALL, start_address=0, end_address=0, progress=None):
+        """
+        Erases the device.
 
-    def erase(self, erase_action=EraseAction.ERASE_ALL, start_address=0, end_address=0):
+        @param (optional) EraseAction erase_action: Erase method.
+        @param (optional) int start_address: Start address of the range to erase with ERASE_SECTOR and ERASE_SECTOR_AND_UICR.
+        @param (optional) int end_address: End address of the range to erase with ERASE_SECTOR and ERASE_SECTOR_AND_UICR.
+        @param (optional) callable progress: Called with Progress.ProgressEvent objects while erasing, see Progress.py.
+        """
         if not isinstance(erase_action, EraseAction):
             raise TypeError('Parameter erase_action must be of type int, str or EraseAction enumeration.')
         if not is_u32(start_address):
@@ -409,14 +490,15 @@ class Probe(object):
         start_address = ctypes.c_uint32(start_address)
         end_address = ctypes.c_uint32(end_address)
 
-        result = self._api.lib.NRFJPROG_erase(self._handle, erase_action, start_address, end_address)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        total = None
+        if erase_action.value in (EraseAction.ERASE_SECTOR, EraseAction.ERASE_SECTOR_AND_UICR) and end_address.value >= start_address.value:
+            total = end_address.value - start_address.value + 1
+
+        with Progress.track(self._logger, progress, 'erase', total=total):
+            self._call(self._lib.NRFJPROG_erase, self._handle, erase_action, start_address, end_address)
 
     def recover(self):
-        result = self._api.lib.NRFJPROG_recover(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_recover, self._handle)
 
     def read(self, address, data_len=4):
         if not is_u32(address):
@@ -431,20 +513,37 @@ class Probe(object):
         if data_len.value == 4:
             data = ctypes.c_uint32(0)
 
-            result = self._api.lib.NRFJPROG_read_u32(self._handle, address, ctypes.byref(data))
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_read_u32, self._handle, address, ctypes.byref(data))
 
             return data.value
 
         else:
-            data = (ctypes.c_uint8 * data_len.value)()
+            data = bytearray(data_len.value)
+            self.read_into(address.value, data)
+            return data
 
-            result = self._api.lib.NRFJPROG_read(self._handle, address, ctypes.byref(data), data_len)
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+    def read_into(self, address, buffer):
+        """
+        Reads data from the device starting at the given address into a caller-owned buffer.
+        The buffer is filled in place, so the same buffer can be reused for repeated reads without allocating new memory.
+
+        @param int address: Start address of the memory block to read.
+        @param buffer buffer: Writable buffer (i.e. bytearray, memoryview, array...) to read into. Its size in bytes is the number of bytes to read.
+        @return int: Number of bytes read.
+        """
+        if not is_u32(address):
+            raise TypeError('The address parameter must fit an unsigned 32-bit value.')
 
-            return bytearray(data)
+        if not is_writable_buf(buffer):
+            raise TypeError('The buffer parameter must be a writable and contiguous buffer.')
+
+        address = ctypes.c_uint32(address)
+        data = to_c_uint8_array(buffer)
+        data_len = ctypes.c_uint32(len(data))
+
+        self._call(self._lib.NRFJPROG_read, self._handle, address, ctypes.byref(data), data_len)
+
+        return data_len.value
 
     def write(self, address, data):
 
@@ -456,19 +555,13 @@ class Probe(object):
         if is_u32(data):
             data = ctypes.c_uint32(data)
 
-            result = self._api.lib.NRFJPROG_write_u32(self._handle, address, data)
-
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_write_u32, self._handle, address, data)
         elif is_valid_buf(data):
 
+            data = to_c_uint8_array(data)
             data_len = ctypes.c_uint32(len(data))
-            data = (ctypes.c_uint8 * data_len.value)(*data)
 
-            result = self._api.lib.NRFJPROG_write(self._handle, address, ctypes.byref(data), data_len)
-
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_write, self._handle, address, ctypes.byref(data), data_len)
         else:
             raise ValueError('The data parameter must be a uint32-representable value, or a sequence of uint8-representable values with at least one item.')
 
@@ -478,9 +571,7 @@ class Probe(object):
 
         reset_action = ctypes.c_int(decode_enum(reset_action, ResetAction))
 
-        result = self._api.lib.NRFJPROG_reset(self._handle, reset_action)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_reset, self._handle, reset_action)
 
     def run(self, pc, sp):
 
@@ -493,9 +584,7 @@ class Probe(object):
         pc = ctypes.c_uint32(pc)
         sp = ctypes.c_uint32(sp)
 
-        result = self._api.lib.NRFJPROG_run(self._handle, pc, sp)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_run, self._handle, pc, sp)
 
 
 class MCUBootDFUProbe(Probe):
@@ -529,16 +618,14 @@ class MCUBootDFUProbe(Probe):
             baud_rate = ctypes.c_uint32(baud_rate)
             timeout = ctypes.c_uint32(timeout)
 
-            result = self._api.lib.NRFJPROG_mcuboot_dfu_init_ex(ctypes.byref(self._handle), None, self._logger.log_cb, None, serial_port, baud_rate, timeout)
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_mcuboot_dfu_init_ex, ctypes.byref(self._handle), None, self._logger.log_cb, None, serial_port, baud_rate, timeout)
         except (APIError, TypeError):
             self._handle = None
             raise
 
-    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_NONE):
+    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_NONE, progress=None):
         """ Override base verify implementation to get correct default action """
-        Probe.verify(self, hex_path, verify_action)
+        Probe.verify(self, hex_path, verify_action, progress)
 
 
 class ModemUARTDFUProbe(Probe):
@@ -571,16 +658,14 @@ class ModemUARTDFUProbe(Probe):
             baud_rate = ctypes.c_uint32(baud_rate)
             timeout = ctypes.c_uint32(timeout)
 
-            result = self._api.lib.NRFJPROG_modemdfu_dfu_serial_init_ex(ctypes.byref(self._handle), None, self._logger.log_cb, None, serial_port, baud_rate, timeout)
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_modemdfu_dfu_serial_init_ex, ctypes.byref(self._handle), None, self._logger.log_cb, None, serial_port, baud_rate, timeout)
         except (APIError, TypeError):
             self._handle = None
             raise
 
-    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_HASH):
+    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_HASH, progress=None):
         """ Override base verify implementation to get correct default action """
-        Probe.verify(self, hex_path, verify_action)
+        Probe.verify(self, hex_path, verify_action, progress)
 
 
 class IPCDFUProbe(Probe):
@@ -620,16 +705,14 @@ class IPCDFUProbe(Probe):
                 raise TypeError('Parameter coprocessor must be of type int, str or CoProcessor enumeration.')
             coprocessor = ctypes.c_int(decode_enum(coprocessor, CoProcessor))
 
-            result = self._api.lib.NRFJPROG_dfu_init_ex(ctypes.byref(self._handle), None, self._logger.log_cb, None, snr, clock_speed, coprocessor, jlink_arm_dll_path)
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_dfu_init_ex, ctypes.byref(self._handle), None, self._logger.log_cb, None, snr, clock_speed, coprocessor, jlink_arm_dll_path)
         except (APIError, TypeError):
             self._handle = None
             raise
 
-    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_HASH):
+    def verify(self, hex_path, verify_action=VerifyAction.VERIFY_HASH, progress=None):
         """ Override base verify implementation to get correct default action """
-        Probe.verify(self, hex_path, verify_action)
+        Probe.verify(self, hex_path, verify_action, progress)
 
 
 class DebugProbe(Probe):
@@ -665,9 +748,7 @@ class DebugProbe(Probe):
             if jlink_arm_dll_path is not None:
                 jlink_arm_dll_path = str(jlink_arm_dll_path).encode('utf-8')
 
-            result = self._api.lib.NRFJPROG_probe_init_ex(ctypes.byref(self._handle), None, self._logger.log_cb, None, snr, clock_speed, jlink_arm_dll_path)
-            if result != NrfjprogdllErr.SUCCESS:
-                raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+            self._call(self._lib.NRFJPROG_probe_init_ex, ctypes.byref(self._handle), None, self._logger.log_cb, None, snr, clock_speed, jlink_arm_dll_path)
         except (APIError, TypeError):
             self._handle = None
             raise
@@ -687,9 +768,7 @@ class DebugProbe(Probe):
         """
         started = ctypes.c_bool()
 
-        result = self._api.lib.NRFJPROG_is_rtt_started(self._handle, ctypes.byref(started))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_is_rtt_started, self._handle, ctypes.byref(started))
 
         return started.value
 
@@ -704,18 +783,14 @@ class DebugProbe(Probe):
 
         addr = ctypes.c_uint32(addr)
 
-        result = self._api.lib.NRFJPROG_rtt_set_control_block_address(self._handle, addr)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_set_control_block_address, self._handle, addr)
 
     def rtt_start(self):
         """
         Starts RTT.
 
         """
-        result = self._api.lib.NRFJPROG_rtt_start(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_start, self._handle)
 
     def rtt_is_control_block_found(self):
         """
@@ -725,9 +800,7 @@ class DebugProbe(Probe):
         """
         is_control_block_found = ctypes.c_bool()
 
-        result = self._api.lib.NRFJPROG_rtt_is_control_block_found(self._handle, ctypes.byref(is_control_block_found))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_is_control_block_found, self._handle, ctypes.byref(is_control_block_found))
 
         return is_control_block_found.value
 
@@ -736,9 +809,7 @@ class DebugProbe(Probe):
         Stops RTT.
 
         """
-        result = self._api.lib.NRFJPROG_rtt_stop(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_stop, self._handle)
 
     def rtt_read(self, channel_index, length, encoding='utf-8'):
         """
@@ -758,24 +829,42 @@ class DebugProbe(Probe):
         if encoding is not None and not is_valid_encoding(encoding):
             raise ValueError('The encoding parameter must be either None or a standard encoding in python.')
 
+        data = bytearray(length)
+        del data[self.rtt_read_into(channel_index, data):]
+
+        return data if encoding is None else data.decode(encoding).encode('utf-8') if sys.version_info[0] == 2 else data.decode(encoding)
+
+    def rtt_read_into(self, channel_index, buffer):
+        """
+        Reads from an RTT channel into a caller-owned buffer.
+        The buffer is filled in place, so the same buffer can be reused for repeated reads without allocating new memory.
+
+        @param int channel_index: RTT channel to read.
+        @param buffer buffer: Writable buffer (i.e. bytearray, memoryview, array...) to read into. Its size in bytes is the maximum number of bytes to read.
+        @return int: Number of bytes read. Only the first bytes of the buffer up to this count are updated.
+        """
+        if not is_u32(channel_index):
+            raise ValueError('The channel_index parameter must be an unsigned 32-bit value.')
+
+        if not is_writable_buf(buffer):
+            raise ValueError('The buffer parameter must be a writable and contiguous buffer.')
+
         channel_index = ctypes.c_uint32(channel_index)
-        length = ctypes.c_uint32(length)
-        data = (ctypes.c_uint8 * length.value)()
+        data = to_c_uint8_array(buffer)
+        length = ctypes.c_uint32(len(data))
         data_read = ctypes.c_uint32()
 
-        result = self._api.lib.NRFJPROG_rtt_read(self._handle, channel_index, ctypes.byref(data), length, ctypes.byref(data_read))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_read, self._handle, channel_index, ctypes.byref(data), length, ctypes.byref(data_read))
 
-        return bytearray(data[0:data_read.value]) if encoding is None else bytearray(data[0:data_read.value]).decode(encoding).encode('utf-8') if sys.version_info[0] == 2 else bytearray(data[0:data_read.value]).decode(encoding)
+        return data_read.value
 
     def rtt_write(self, channel_index, msg, encoding='utf-8'):
         """
         Writes to an RTT channel.
 
         @param int channel_index: RTT channel to write.
-        @param sequence msg: Data to write. Any type that implements the sequence API (i.e. string, list, bytearray...) is valid as input.
-        @param (optional) str or None encoding: Encoding of the msg to write. Default value 'utf-8'.
+        @param str, buffer or sequence msg: Data to write. A string is encoded with encoding, buffers (bytes, bytearray, memoryview...) and sequences of uint8 values are passed as they are, see to_c_uint8_array().
+        @param (optional) str or None encoding: Encoding of a string msg. Default value 'utf-8'.
         @return int: Number of bytes written.  Note that if non-'latin-1' characters are used, the number of bytes written depends on the encoding parameter given.
         """
         if not is_u32(channel_index):
@@ -784,18 +873,17 @@ class DebugProbe(Probe):
         if encoding is not None and not is_valid_encoding(encoding):
             raise ValueError('The encoding parameter must be either None or a standard encoding in python.')
 
-        msg = bytearray(msg.encode(encoding)) if encoding else bytearray(msg)
+        if encoding and isinstance(msg, str):
+            msg = msg.encode(encoding)
         if not is_valid_buf(msg):
             raise ValueError('The msg parameter must be a sequence type with at least one item.')
 
         channel_index = ctypes.c_uint32(channel_index)
-        length = ctypes.c_uint32(len(msg))
-        data = (ctypes.c_uint8 * length.value)(*msg)
+        data = to_c_uint8_array(msg)
+        length = ctypes.c_uint32(len(data))
         data_written = ctypes.c_uint32()
 
-        result = self._api.lib.NRFJPROG_rtt_write(self._handle, channel_index, ctypes.byref(data), length, ctypes.byref(data_written))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_write, self._handle, channel_index, ctypes.byref(data), length, ctypes.byref(data_written))
 
         return data_written.value
 
@@ -808,9 +896,7 @@ class DebugProbe(Probe):
         down_channel_number = ctypes.c_uint32()
         up_channel_number = ctypes.c_uint32()
 
-        result = self._api.lib.NRFJPROG_rtt_read_channel_count(self._handle, ctypes.byref(down_channel_number), ctypes.byref(up_channel_number))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_read_channel_count, self._handle, ctypes.byref(down_channel_number), ctypes.byref(up_channel_number))
 
         return down_channel_number.value, up_channel_number.value
 
@@ -838,8 +924,6 @@ class DebugProbe(Probe):
         name = (ctypes.c_uint8 * 32)()
         size = ctypes.c_uint32()
 
-        result = self._api.lib.NRFJPROG_rtt_read_channel_info(self._handle, channel_index, direction, ctypes.byref(name), name_len, ctypes.byref(size))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors(), log=self._logger.error)
+        self._call(self._lib.NRFJPROG_rtt_read_channel_info, self._handle, channel_index, direction, ctypes.byref(name), name_len, ctypes.byref(size))
 
         return ''.join(chr(i) for i in name if i != 0), size.value
@@ -0,0 +1,396 @@
+"""
+This module instruments the DLL calls made by LowLevel.API, HighLevel.API and HighLevel.Probe instances.
+
+Instrumentation is opt-in and per instance. add_call_observer() wraps the library of the instance in an
+InstrumentedLibrary, which times each NRFJPROG_* call and passes it to the observers. The library is unwrapped again
+when the last observer is removed, so instances without observers run at full speed. Observers added to a HighLevel.API
+are also added to the probes created afterwards.
+
+An observer is any object with an on_call(owner, name, args, result, start, end) method, where owner is the API or probe
+making the call, args the ctypes arguments after the call, result the return code, and start and end time.perf_counter()
+values. The time spent waiting for error messages in get_errors() is reported under the name 'get_errors'. Observers can
+also define on_attach(owner) and on_detach(owner), called when they are added to and removed from an instance.
+
+LatencyRecorder is an observer counting the calls and their latency per instance and function.
+
+Example:
+    recorder = Instrumentation.LatencyRecorder('station 1')
+    api.add_call_observer(recorder)
+    ...
+    print(recorder.report())
+"""
+
+from __future__ import print_function
+
+import collections
+import threading
+import time
+import weakref
+
+
+class InstrumentedLibrary(object):
+    """
+    Proxy of an nrfjprog library that notifies observers of each function call.
+    """
+
+    def __init__(self, library, owner):
+        """
+        @param library: Library to wrap, as returned by _load_library().
+        @param owner: API or probe making the calls, passed to the observers.
+        """
+        self.library = library
+        self.owner = owner
+        # Replaced, never modified, so that calls in progress on other threads iterate over a consistent tuple.
+        self.observers = tuple()
+
+    def add_observer(self, observer):
+        if observer in self.observers:
+            return
+        self.observers = self.observers + (observer,)
+        if hasattr(observer, 'on_attach'):
+            observer.on_attach(self.owner)
+
+    def remove_observer(self, observer):
+        if observer not in self.observers:
+            return
+        self.observers = tuple(item for item in self.observers if item != observer)
+        if hasattr(observer, 'on_detach'):
+            observer.on_detach(self.owner)
+
+    def notify(self, name, args, result, start, end):
+        for observer in self.observers:
+            observer.on_call(self.owner, name, args, result, start, end)
+
+    def __getattr__(self, name):
+        function = getattr(self.library, name)
+        if not callable(function):
+            return function
+
+        perf_counter = time.perf_counter
+
+        def call(*args):
+            start = perf_counter()
+            result = function(*args)
+            end = perf_counter()
+            for observer in self.observers:
+                observer.on_call(self.owner, name, args, result, start, end)
+            return result
+
+        call.__name__ = name
+        # Cache the wrapper, so that __getattr__ is only called once per function.
+        setattr(self, name, call)
+        return call
+
+
+def short_name(name):
+    """
+    @return str: Function name without the NRFJPROG_ prefix and _inst suffix, i.e. read_u32 for NRFJPROG_read_u32_inst.
+    """
+    if name.startswith('NRFJPROG_'):
+        name = name[len('NRFJPROG_'):]
+    if name.endswith('_inst'):
+        name = name[:-len('_inst')]
+    return name
+
+
+def add_call_observer(library, owner, observer):
+    """
+    Adds an observer to a library, wrapping it in an InstrumentedLibrary if needed.
+
+    @return InstrumentedLibrary: The library to use from now on.
+    """
+    if not isinstance(library, InstrumentedLibrary):
+        library = InstrumentedLibrary(library, owner)
+    library.add_observer(observer)
+    return library
+
+
+def remove_call_observer(library, observer):
+    """
+    Removes an observer from a library, unwrapping it when it has no observers left.
+
+    @return: The library to use from now on.
+    """
+    if not isinstance(library, InstrumentedLibrary):
+        return library
+    library.remove_observer(observer)
+    return library if library.observers else library.library
+
+
+def unwrap(library):
+    """
+    @return: The library wrapped by an InstrumentedLibrary, or library itself if it is not instrumented.
+    """
+    return library.library if isinstance(library, InstrumentedLibrary) else library
+
+
+def call_observers(library):
+    """
+    @return tuple: Observers of a library.
+    """
+    return library.observers if isinstance(library, InstrumentedLibrary) else tuple()
+
+
+def timed(library, name, function, *args):
+    """
+    Calls a Python function and reports its duration to the observers of library under the given name.
+    """
+    if not isinstance(library, InstrumentedLibrary):
+        return function(*args)
+
+    start = time.perf_counter()
+    result = function(*args)
+    library.notify(name, args, result, start, time.perf_counter())
+    return result
+
+
+class LatencyHistogram(object):
+    """
+    Log-linear latency histogram in the style of HdrHistogram.
+
+    Latencies are counted in nanoseconds. Each power of two is split in 2 ** sub_bucket_bits linear buckets, so recorded
+    values are kept with a relative error below 2 ** -sub_bucket_bits. Recording is O(1) and the memory used is bounded.
+    """
+
+    def __init__(self, sub_bucket_bits=4):
+        self._sub_bucket_bits = sub_bucket_bits
+        self._sub_buckets = 1 << sub_bucket_bits
+        # Enough buckets for latencies up to 2 ** 48 ns, i.e. several days.
+        self.counts = [0] * ((48 - sub_bucket_bits + 1) * self._sub_buckets)
+        self.count = 0
+        self.total = 0
+        self.min = None
+        self.max = None
+
+    def _index(self, value):
+        if value < self._sub_buckets:
+            return value
+        shift = value.bit_length() - self._sub_bucket_bits - 1
+        return min((shift + 1) * self._sub_buckets + (value >> shift) - self._sub_buckets, len(self.counts) - 1)
+
+    def _lowest_value(self, index):
+        """ Lowest value counted in a bucket. """
+        if index < self._sub_buckets:
+            return index
+        shift = index // self._sub_buckets - 1
+        return (index % self._sub_buckets + self._sub_buckets) << shift
+
+    def record(self, value):
+        """
+        @param int value: Latency in nanoseconds.
+        """
+        self.counts[self._index(value)] += 1
+        self.count += 1
+        self.total += value
+        if self.min is None or value < self.min:
+            self.min = value
+        if self.max is None or value > self.max:
+            self.max = value
+
+    def percentile(self, percentile):
+        """
+        @param float percentile: Percentile between 0 and 100.
+        @return int: Latency in nanoseconds at or below which the given percentage of the calls completed, None if empty.
+        """
+        if self.count == 0:
+            return None
+
+        rank = max(1, int(round(self.count * percentile / 100.0)))
+        seen = 0
+        for index, count in enumerate(self.counts):
+            seen += count
+            if seen >= rank:
+                # The highest value of the bucket, bounded by the recorded extremes.
+                value = self._lowest_value(index + 1) - 1
+                return max(self.min, min(value, self.max))
+        return self.max
+
+    def mean(self):
+        return self.total / self.count if self.count else None
+
+    def merge(self, other):
+        """
+        Adds the values recorded by another histogram with the same sub_bucket_bits.
+        """
+        for index, count in enumerate(other.counts):
+            self.counts[index] += count
+        self.count += other.count
+        self.total += other.total
+        if other.min is not None and (self.min is None or other.min < self.min):
+            self.min = other.min
+        if other.max is not None and (self.max is None or other.max > self.max):
+            self.max = other.max
+
+    def to_dict(self):
+        """
+        @return dict: Summary of the histogram, latencies in nanoseconds, and the non-empty buckets as (lowest value, count) pairs.
+        """
+        return {
+            'count': self.count,
+            'total_ns': self.total,
+            'min_ns': self.min,
+            'max_ns': self.max,
+            'mean_ns': self.mean(),
+            'p50_ns': self.percentile(50),
+            'p90_ns': self.percentile(90),
+            'p99_ns': self.percentile(99),
+            'buckets': [(self._lowest_value(index), count) for index, count in enumerate(self.counts) if count],
+        }
+
+
+class LatencyRecorder(object):
+    """
+    Call observer keeping a LatencyHistogram per instance and function. Thread-safe.
+    One recorder can observe several instances, i.e. a HighLevel.API and its probes, their calls are counted separately.
+    When an instance is deleted its histograms are merged into one set for all the deleted instances, so the memory used
+    does not grow with the number of instances.
+    """
+
+    def __init__(self, label=None, sub_bucket_bits=4):
+        """
+        @param (optional) str label: Name of the recorder in reports, i.e. the name of the station.
+        @param (optional) int sub_bucket_bits: See LatencyHistogram.
+        """
+        self.label = label
+        self._sub_bucket_bits = sub_bucket_bits
+        # Histograms by function name, by owner id.
+        self._histograms = dict()
+        # (weak reference, label) of the live owners by owner id, in the order they were first seen.
+        self._owners = dict()
+        # Number of owners seen, to label them.
+        self._owner_count = 0
+        # Histograms by function name of the deleted owners, and their number.
+        self._deleted_histograms = dict()
+        self._deleted_count = 0
+        # Ids of the owners deleted since the last call. Filled by their finalizers, which can run in any thread and while
+        # the lock is held, and emptied under the lock.
+        self._deleted_keys = collections.deque()
+        self._lock = threading.Lock()
+
+    def _merge_deleted(self):
+        while self._deleted_keys:
+            self._merge_owner(self._deleted_keys.popleft())
+
+    def _merge_owner(self, key):
+        """ Moves the histograms of a deleted owner to the histograms of the deleted owners. """
+        if self._owners.pop(key, None) is None:
+            return
+        self._deleted_count += 1
+        for name, histogram in self._histograms.pop(key).items():
+            total = self._deleted_histograms.get(name)
+            if total is None:
+                self._deleted_histograms[name] = histogram
+            else:
+                total.merge(histogram)
+
+    def _owner_histograms(self, owner):
+        key = id(owner)
+        entry = self._owners.get(key)
+        if entry is None or entry[0]() is not owner:
+            if entry is not None:
+                # The finalizer of the previous owner with this id has not been seen yet.
+                self._merge_owner(key)
+            self._owner_count += 1
+            label = '{} {}'.format(type(owner).__name__, self._owner_count)
+            try:
+                reference = weakref.ref(owner)
+                weakref.finalize(owner, self._deleted_keys.append, key)
+            except TypeError:
+                reference = lambda owner=owner: owner
+            self._owners[key] = (reference, label)
+            self._histograms[key] = dict()
+        return self._histograms[key]
+
+    def on_call(self, owner, name, args, result, start, end):
+        elapsed = int((end - start) * 1e9)
+        with self._lock:
+            if self._deleted_keys:
+                self._merge_deleted()
+            histograms = self._owner_histograms(owner)
+            histogram = histograms.get(name)
+            if histogram is None:
+                histogram = histograms[name] = LatencyHistogram(self._sub_bucket_bits)
+            histogram.record(elapsed)
+
+    def reset(self):
+        with self._lock:
+            self._merge_deleted()
+            self._histograms.clear()
+            self._owners.clear()
+            self._deleted_histograms.clear()
+            self._deleted_count = 0
+
+    def _owner_label(self, key):
+        """ Label of an owner, with the serial number of its debug probe when it is known. """
+        reference, label = self._owners[key]
+        owner = reference()
+        serial_number = getattr(getattr(owner, '_logger', None), 'extra', None)
+        return '{} ({})'.format(label, serial_number) if serial_number is not None else label
+
+    def histograms(self, owner=None):
+        """
+        @param (optional) owner: API or probe whose histograms are returned. None merges the histograms of all the instances.
+        @return dict: Copy of the histograms by function name, without the NRFJPROG_ prefix and _inst suffix.
+        """
+        with self._lock:
+            self._merge_deleted()
+            if owner is not None:
+                entry = self._owners.get(id(owner))
+                if entry is None or entry[0]() is not owner:
+                    return dict()
+                sources = [self._histograms[id(owner)]]
+            else:
+                sources = list(self._histograms.values()) + [self._deleted_histograms]
+
+            merged = dict()
+            for histograms in sources:
+                for name, histogram in histograms.items():
+                    total = merged.get(short_name(name))
+                    if total is None:
+                        total = merged[short_name(name)] = LatencyHistogram(self._sub_bucket_bits)
+                    total.merge(histogram)
+            return merged
+
+    def to_dict(self):
+        """
+        @return dict: Label of the recorder, histogram summaries by function name of all the instances together, and by
+        instance label. The deleted instances are summarized together. See LatencyHistogram.to_dict().
+        """
+        with self._lock:
+            self._merge_deleted()
+            owners = dict((self._owner_label(key), dict((short_name(name), histogram.to_dict()) for name, histogram in histograms.items()))
+                          for key, histograms in self._histograms.items())
+            if self._deleted_count:
+                owners['{} deleted instances'.format(self._deleted_count)] = dict(
+                    (short_name(name), histogram.to_dict()) for name, histogram in self._deleted_histograms.items())
+        functions = dict((name, histogram.to_dict()) for name, histogram in self.histograms().items())
+        return {'label': self.label, 'functions': functions, 'owners': owners}
+
+    @staticmethod
+    def _table(functions):
+        summaries = sorted(functions.items(), key=lambda item: item[1]['total_ns'], reverse=True)
+        total = sum(summary['total_ns'] for _, summary in summaries)
+
+        lines = list()
+        lines.append('{:<36} {:>8} {:>11} {:>6} {:>10} {:>10} {:>10} {:>10}'.format(
+            'function', 'calls', 'total ms', '%', 'mean us', 'p50 us', 'p99 us', 'max us'))
+        for name, summary in summaries:
+            lines.append('{:<36} {:>8} {:>11.3f} {:>6.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}'.format(
+                name, summary['count'], summary['total_ns'] / 1e6, 100.0 * summary['total_ns'] / total if total else 0.0,
+                summary['mean_ns'] / 1e3, summary['p50_ns'] / 1e3, summary['p99_ns'] / 1e3, summary['max_ns'] / 1e3))
+        return lines
+
+    def report(self):
+        """
+        @return str: Table of the functions called by each instance, sorted by total time.
+        """
+        owners = self.to_dict()['owners']
+
+        lines = list()
+        if self.label is not None:
+            lines.append('{}:'.format(self.label))
+        for label, functions in owners.items():
+            if len(owners) > 1:
+                lines.append('{}:'.format(label))
+            lines.extend(self._table(functions))
+        return '\n'.join(lines)
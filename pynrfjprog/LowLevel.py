@@ -19,11 +19,17 @@ import logging
 from pathlib import Path
 
 try:
+    from . import Instrumentation
     from . import JLink
+    from . import Progress
+    from . import Trace
     from .Parameters import *
     from .APIError import *
 except Exception:
+    import Instrumentation
     import JLink
+    import Progress
+    import Trace
     from Parameters import *
     from APIError import *
 
@@ -48,7 +54,7 @@ class API(object):
     _DEFAULT_JLINK_SPEED_KHZ = 2000
 
     def __init__(self, device_family, jlink_arm_dll_path=None, log_str_cb=None, log=False, log_str=None,
-                 log_file_path=None, log_stringio=None):
+                 log_file_path=None, log_stringio=None, trace=None, dll_messages=True):
         """
         Constructor.
 
@@ -59,6 +65,8 @@ class API(object):
         @param (optional) str log_str: If present, will enable logging to sys.stderr with overwriten default log string appended to the beginning of each debug output line.
         @param (optional) str log_file_path: If present, will enable logging to log_file specified. This file will be opened in write mode in API.__init__() and api.open(), and closed when api.close() is called.
         @param (optional) str log_stringio: If present, will enable logging to open file-like object specified.
+        @param (optional) str or Trace.TraceRecorder trace: If present, will record the DLL calls as a Chrome trace_event timeline, see Trace.py. A file path is written when api.close() is called.
+        @param (optional) bool dll_messages: If false and logging is disabled, the DLL does not pass its messages to Python, which saves a callback per message. The progress of program_file() is then limited to its start and end events.
         """
         self._device_family = None
         self._jlink_arm_dll_path = None
@@ -84,8 +92,26 @@ class API(object):
 
         _logger = logging.getLogger(__name__)
         self._logger = Parameters.LoggerAdapter(_logger, None, log=log, log_str_cb=log_str_cb, log_str=log_str, log_file_path=log_file_path,
-                                         log_stringio=log_stringio)
+                                         log_stringio=log_stringio, dll_messages=dll_messages)
 
+        self._lib = self._load_library()
+
+        # Trace recorder created by this api for a trace file path, saved in api.close().
+        self._trace = None
+        self._trace_file_path = None
+        if isinstance(trace, Trace.TraceRecorder):
+            self.add_call_observer(trace)
+        elif trace is not None:
+            self._trace = Trace.TraceRecorder()
+            self._trace_file_path = trace
+            self.add_call_observer(self._trace)
+
+    def _load_library(self):
+        """
+        Loads the nrfjprog DLL. Subclasses can override it to use another implementation, see Simulator.py.
+
+        @return: Object providing the NRFJPROG_*_inst functions.
+        """
         this_dir = os.path.dirname(__file__)
 
         if sys.maxsize > 2 ** 32:
@@ -108,12 +134,12 @@ class API(object):
 
         if os.path.exists(nrfjprog_dll_path):
             try:
-                self._lib = ctypes.cdll.LoadLibrary(nrfjprog_dll_path)
+                return ctypes.cdll.LoadLibrary(nrfjprog_dll_path)
             except Exception as error:
                 raise RuntimeError("Could not load the NRFJPROG DLL: '{}'.".format(error))
         else:
             try:
-                self._lib = ctypes.cdll.LoadLibrary(nrfjprog_dll_name)
+                return ctypes.cdll.LoadLibrary(nrfjprog_dll_name)
             except Exception as error:
                 raise RuntimeError("Failed to load the NRFJPROG DLL by name: '{}.'".format(error))
 
@@ -132,9 +158,7 @@ class API(object):
         minor = ctypes.c_uint32()
         revision = ctypes.c_uint8()
 
-        result = self._lib.NRFJPROG_dll_version_inst(self._handle,  ctypes.byref(major), ctypes.byref(minor), ctypes.byref(revision))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_dll_version_inst, self._handle,  ctypes.byref(major), ctypes.byref(minor), ctypes.byref(revision))
         return major.value, minor.value, chr(revision.value)
 
     def is_open(self):
@@ -145,9 +169,7 @@ class API(object):
         """
         opened = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_dll_open_inst(self._handle,  ctypes.byref(opened))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_dll_open_inst, self._handle,  ctypes.byref(opened))
         return opened.value
 
     def open(self):
@@ -159,9 +181,7 @@ class API(object):
         # Function self._log_str_cb has already been encoded in __init__() function.
         device_family = ctypes.c_int(self._device_family.value)
 
-        result = self._lib.NRFJPROG_open_dll_inst(ctypes.byref(self._handle), self._jlink_arm_dll_path, self._logger.log_cb, None, device_family)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_open_dll_inst, ctypes.byref(self._handle), self._jlink_arm_dll_path, self._logger.log_cb, None, device_family)
 
         # Make sure that api is closed before api is destroyed
         self._finalizer = weakref.finalize(self, self.close)
@@ -172,18 +192,51 @@ class API(object):
 
         """
         self._lib.NRFJPROG_close_dll_inst(ctypes.byref(self._handle))
+        self._logger.close()
+
+        if self._trace is not None:
+            self._trace.save(self._trace_file_path)
 
         # Disable the api finalizer, as it's no longer necessary when the api is closed.
         self._finalizer.detach()
 
-    def get_errors(self):
+    def get_errors(self, since=None):
         """
         Gets last logged error messages from the nrfjprog dll.
         Used to fill in APIError messages.
 
+        @param (optional) int since: Error sequence number taken with self._logger.error_sequence() before the failing call. Defaults to the messages since the previous get_errors() call.
         @Return list of error strings.
         """
-        return self._logger.get_errors()
+        return Instrumentation.timed(self._lib, 'get_errors', self._logger.get_errors, since)
+
+    def _call(self, function, *args, err_msg=""):
+        """
+        Calls a DLL function, and raises an APIError with the error messages the DLL reported during the call if it fails.
+
+        @param callable function: Function of self._lib.
+        @param (optional) str err_msg: Message of the APIError.
+        """
+        since = self._logger.error_sequence()
+        result = function(*args)
+        if result != NrfjprogdllErr.SUCCESS:
+            raise APIError(result, err_msg, error_data=self.get_errors(since))
+
+    def add_call_observer(self, observer):
+        """
+        Adds an observer of the DLL calls made by this API, see Instrumentation.py.
+
+        @param observer: Object with an on_call(owner, name, args, result, start, end) method.
+        """
+        self._lib = Instrumentation.add_call_observer(self._lib, self, observer)
+
+    def remove_call_observer(self, observer):
+        """
+        Removes an observer added with add_call_observer().
+
+        @param observer: Observer to remove.
+        """
+        self._lib = Instrumentation.remove_call_observer(self._lib, observer)
 
     def enum_emu_com_ports(self, serial_number):
         """
@@ -202,10 +255,8 @@ class API(object):
         num_com_ports = ctypes.c_uint32()
         com_ports = (ComPortInfoStruct * NRFJPROG_COM_PER_JLINK)()
 
-        result = self._lib.NRFJPROG_enum_emu_com_inst(self._handle,  serial_number, ctypes.byref(com_ports), com_ports_len,
-                               ctypes.byref(num_com_ports))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_enum_emu_com_inst, self._handle,  serial_number, ctypes.byref(com_ports), com_ports_len,
+                   ctypes.byref(num_com_ports))
 
         return [ComPortInfo(comport) for comport in com_ports[0:num_com_ports.value]]
 
@@ -219,10 +270,8 @@ class API(object):
         serial_numbers = (ctypes.c_uint32 * serial_numbers_len.value)()
         num_available = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_enum_emu_snr_inst(self._handle,  ctypes.byref(serial_numbers), serial_numbers_len,
-                               ctypes.byref(num_available))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_enum_emu_snr_inst, self._handle,  ctypes.byref(serial_numbers), serial_numbers_len,
+                   ctypes.byref(num_available))
 
         snr = [int(serial_numbers[i]) for i in range(0, min(num_available.value, serial_numbers_len.value))]
 
@@ -239,9 +288,7 @@ class API(object):
         """
         is_connected_to_emu = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_connected_to_emu_inst(self._handle,  ctypes.byref(is_connected_to_emu))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_connected_to_emu_inst, self._handle,  ctypes.byref(is_connected_to_emu))
 
         return is_connected_to_emu.value
 
@@ -263,10 +310,11 @@ class API(object):
         serial_number = ctypes.c_uint32(serial_number)
         jlink_speed_khz = ctypes.c_uint32(jlink_speed_khz)
 
-        result = self._lib.NRFJPROG_connect_to_emu_with_snr_inst(self._handle,  serial_number, jlink_speed_khz)
-        if result != NrfjprogdllErr.SUCCESS:
+        try:
+            self._call(self._lib.NRFJPROG_connect_to_emu_with_snr_inst, self._handle,  serial_number, jlink_speed_khz)
+        except APIError:
             self._logger.set_id(None)
-            raise APIError(result, error_data=self.get_errors())
+            raise
 
     def connect_to_emu_without_snr(self, jlink_speed_khz=_DEFAULT_JLINK_SPEED_KHZ):
         """
@@ -279,9 +327,7 @@ class API(object):
 
         jlink_speed_khz = ctypes.c_uint32(jlink_speed_khz)
 
-        result = self._lib.NRFJPROG_connect_to_emu_without_snr_inst(self._handle,  jlink_speed_khz)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_connect_to_emu_without_snr_inst, self._handle,  jlink_speed_khz)
 
         self._logger.set_id(self.read_connected_emu_snr())
 
@@ -289,17 +335,13 @@ class API(object):
         """
         Resets the connected emulator.
         """
-        result = self._lib.NRFJPROG_reset_connected_emu_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_reset_connected_emu_inst, self._handle)
 
     def replace_connected_emu_fw(self):
         """
         Replaces the firmware of the connected emulator.
         """
-        result = self._lib.NRFJPROG_replace_connected_emu_fw_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_replace_connected_emu_fw_inst, self._handle)
 
     def read_connected_emu_snr(self):
         """
@@ -309,9 +351,7 @@ class API(object):
         """
         snr = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_read_connected_emu_snr_inst(self._handle,  ctypes.byref(snr))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_connected_emu_snr_inst, self._handle,  ctypes.byref(snr))
 
         return snr.value
 
@@ -324,9 +364,7 @@ class API(object):
         buffer_size = ctypes.c_uint32(255)
         fwstr = ctypes.create_string_buffer(buffer_size.value)
 
-        result = self._lib.NRFJPROG_read_connected_emu_fwstr_inst(self._handle,  fwstr, buffer_size)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_connected_emu_fwstr_inst, self._handle,  fwstr, buffer_size)
 
         return fwstr.value if sys.version_info[0] == 2 else fwstr.value.decode('utf-8')
 
@@ -335,9 +373,7 @@ class API(object):
         Disconnects from an emulator.
 
         """
-        result = self._lib.NRFJPROG_disconnect_from_emu_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_disconnect_from_emu_inst, self._handle)
 
     def select_family(self, family):
         """
@@ -350,9 +386,7 @@ class API(object):
         family = decode_enum(family, DeviceFamily)
         family = ctypes.c_int(family)
 
-        result = self._lib.NRFJPROG_select_family_inst(self._handle,  family)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_select_family_inst, self._handle,  family)
 
     def is_coprocessor_enabled(self, coprocessor):
         """
@@ -368,9 +402,7 @@ class API(object):
 
         held = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_coprocessor_enabled_inst(self._handle,  coprocessor, ctypes.byref(held))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_coprocessor_enabled_inst, self._handle,  coprocessor, ctypes.byref(held))
 
         return held.value
 
@@ -385,9 +417,7 @@ class API(object):
         coprocessor = decode_enum(coprocessor, CoProcessor)
         coprocessor = ctypes.c_int(coprocessor)
 
-        result = self._lib.NRFJPROG_enable_coprocessor_inst(self._handle,  coprocessor)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_enable_coprocessor_inst, self._handle,  coprocessor)
 
     def disable_coprocessor(self, coprocessor):
         """
@@ -400,9 +430,7 @@ class API(object):
         coprocessor = decode_enum(coprocessor, CoProcessor)
         coprocessor = ctypes.c_int(coprocessor)
 
-        result = self._lib.NRFJPROG_disable_coprocessor_inst(self._handle,  coprocessor)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_disable_coprocessor_inst, self._handle,  coprocessor)
 
     def select_coprocessor(self, coprocessor):
         """
@@ -415,18 +443,14 @@ class API(object):
         coprocessor = decode_enum(coprocessor, CoProcessor)
         coprocessor = ctypes.c_int(coprocessor)
 
-        result = self._lib.NRFJPROG_select_coprocessor_inst(self._handle,  coprocessor)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_select_coprocessor_inst, self._handle,  coprocessor)
 
     def recover(self):
         """
         Recovers the device.
 
         """
-        result = self._lib.NRFJPROG_recover_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_recover_inst, self._handle)
 
     def is_connected_to_device(self):
         """
@@ -436,9 +460,7 @@ class API(object):
         """
         is_connected_to_device = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_connected_to_device_inst(self._handle,  ctypes.byref(is_connected_to_device))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_connected_to_device_inst, self._handle,  ctypes.byref(is_connected_to_device))
 
         return is_connected_to_device.value
 
@@ -447,18 +469,14 @@ class API(object):
         Connects to the nRF device.
 
         """
-        result = self._lib.NRFJPROG_connect_to_device_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_connect_to_device_inst, self._handle)
 
     def disconnect_from_device(self):
         """
         Disconnects from the device.
         
         """
-        result = self._lib.NRFJPROG_disconnect_from_device_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_disconnect_from_device_inst, self._handle)
 
     def readback_protect(self, desired_protection_level):
         """
@@ -477,9 +495,7 @@ class API(object):
 
         desired_protection_level = ctypes.c_int(desired_protection_level.value)
 
-        result = self._lib.NRFJPROG_readback_protect_inst(self._handle,  desired_protection_level)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_readback_protect_inst, self._handle,  desired_protection_level)
 
     def readback_status(self):
         """
@@ -489,9 +505,7 @@ class API(object):
         """
         status = ctypes.c_int()
 
-        result = self._lib.NRFJPROG_readback_status_inst(self._handle,  ctypes.byref(status))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_readback_status_inst, self._handle,  ctypes.byref(status))
 
         return ReadbackProtection(status.value).name
 
@@ -499,9 +513,7 @@ class API(object):
         """
         Protects the device against erasing.
         """
-        result = self._lib.NRFJPROG_enable_eraseprotect_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_enable_eraseprotect_inst, self._handle)
 
     def is_eraseprotect_enabled(self):
         """
@@ -511,9 +523,7 @@ class API(object):
         """
         status = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_eraseprotect_enabled_inst(self._handle,  ctypes.byref(status))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_eraseprotect_enabled_inst, self._handle,  ctypes.byref(status))
 
         return status.value
 
@@ -526,9 +536,7 @@ class API(object):
         size = ctypes.c_uint32()
         source = ctypes.c_int()
 
-        result = self._lib.NRFJPROG_read_region_0_size_and_source_inst(self._handle,  ctypes.byref(size), ctypes.byref(source))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_region_0_size_and_source_inst, self._handle,  ctypes.byref(size), ctypes.byref(source))
 
         return size.value, Region0Source(source.value).name
 
@@ -537,27 +545,21 @@ class API(object):
         Executes a soft reset using the CTRL-AP for nRF52 and onward devices.
 
         """
-        result = self._lib.NRFJPROG_debug_reset_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_debug_reset_inst, self._handle)
 
     def sys_reset(self):
         """
         Executes a system reset request.
 
         """
-        result = self._lib.NRFJPROG_sys_reset_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_sys_reset_inst, self._handle)
 
     def pin_reset(self):
         """
         Executes a pin reset. If your device has a configurable pin reset, in order for the function execution to have the desired effect the pin reset must be enabled in UICR.PSELRESET[] registers.
 
         """
-        result = self._lib.NRFJPROG_pin_reset_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_pin_reset_inst, self._handle)
 
     def is_bprot_enabled(self, address_start, length):
         """
@@ -579,9 +581,7 @@ class API(object):
         length = ctypes.c_uint32(length)
         bprot_enabled = ctypes.c_bool(False)
 
-        result = self._lib.NRFJPROG_is_bprot_enabled_inst(self._handle,  ctypes.byref(bprot_enabled), address_start, length)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_bprot_enabled_inst, self._handle,  ctypes.byref(bprot_enabled), address_start, length)
 
         return bprot_enabled.value
 
@@ -590,18 +590,14 @@ class API(object):
         Disables BPROT, ACL or NVM protection blocks where appropriate depending on device.
 
         """
-        result = self._lib.NRFJPROG_disable_bprot_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_disable_bprot_inst, self._handle)
 
     def erase_all(self):
         """
         Erases all code and UICR flash.
 
         """
-        result = self._lib.NRFJPROG_erase_all_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_erase_all_inst, self._handle)
 
     def erase_page(self, addr):
         """
@@ -614,18 +610,14 @@ class API(object):
 
         addr = ctypes.c_uint32(addr)
 
-        result = self._lib.NRFJPROG_erase_page_inst(self._handle,  addr)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_erase_page_inst, self._handle,  addr)
 
     def erase_uicr(self):
         """
         Erases UICR info page.
 
         """
-        result = self._lib.NRFJPROG_erase_uicr_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_erase_uicr_inst, self._handle)
 
     def write_u32(self, addr, data, control):
         """
@@ -648,9 +640,7 @@ class API(object):
         data = ctypes.c_uint32(data)
         control = ctypes.c_bool(control)
 
-        result = self._lib.NRFJPROG_write_u32_inst(self._handle,  addr, data, control)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_write_u32_inst, self._handle,  addr, data, control)
 
     def read_u32(self, addr):
         """
@@ -665,9 +655,7 @@ class API(object):
         addr = ctypes.c_uint32(addr)
         data = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_read_u32_inst(self._handle,  addr, ctypes.byref(data))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_u32_inst, self._handle,  addr, ctypes.byref(data))
 
         return data.value
 
@@ -676,7 +664,7 @@ class API(object):
         Writes data from the array into the device starting at the given address.
 
         @param int addr: Start address of the memory block to write.
-        @param sequence data: Data to write. Any type that implements the sequence API (i.e. string, list, bytearray...) is valid as input.
+        @param sequence data: Data to write. Any object supporting the buffer protocol (i.e. bytes, bytearray, memoryview, array, mmap...) is passed to the DLL as raw memory without per-byte conversion. Any other sequence of uint8 values (i.e. list, tuple...) is also valid as input.
         @param boolean control: True for automatic control of NVMC by the function.
         """
         if not is_u32(addr):
@@ -689,13 +677,11 @@ class API(object):
             raise ValueError('The control parameter must be a boolean value.')
 
         addr = ctypes.c_uint32(addr)
+        data = to_c_uint8_array(data)
         data_len = ctypes.c_uint32(len(data))
-        data = (ctypes.c_uint8 * data_len.value)(*data)
         control = ctypes.c_bool(control)
 
-        result = self._lib.NRFJPROG_write_inst(self._handle,  addr, ctypes.byref(data), data_len, control)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_write_inst, self._handle,  addr, ctypes.byref(data), data_len, control)
 
     def read(self, addr, data_len):
         """
@@ -703,7 +689,7 @@ class API(object):
 
         @param int addr: Start address of the memory block to read.
         @param int data_len: Number of bytes to read.
-        @return [int]: List of values read.
+        @return bytearray: Data read.
         """
         if not is_u32(addr):
             raise ValueError('The addr parameter must be an unsigned 32-bit value.')
@@ -711,15 +697,91 @@ class API(object):
         if not is_u32(data_len):
             raise ValueError('The data_len parameter must be an unsigned 32-bit value.')
 
+        data = bytearray(data_len)
+        self.read_into(addr, data)
+        return data
+
+    def read_into(self, addr, buffer):
+        """
+        Reads data from the device starting at the given address into a caller-owned buffer.
+        The buffer is filled in place, so the same buffer can be reused for repeated reads without allocating new memory.
+
+        @param int addr: Start address of the memory block to read.
+        @param buffer buffer: Writable buffer (i.e. bytearray, memoryview, array...) to read into. Its size in bytes is the number of bytes to read.
+        @return int: Number of bytes read.
+        """
+        if not is_u32(addr):
+            raise ValueError('The addr parameter must be an unsigned 32-bit value.')
+
+        if not is_writable_buf(buffer):
+            raise ValueError('The buffer parameter must be a writable and contiguous buffer.')
+
         addr = ctypes.c_uint32(addr)
-        data_len = ctypes.c_uint32(data_len)
-        data = (ctypes.c_uint8 * data_len.value)()
+        data = to_c_uint8_array(buffer)
+        data_len = ctypes.c_uint32(len(data))
 
-        result = self._lib.NRFJPROG_read_inst(self._handle,  addr, ctypes.byref(data), data_len)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_inst, self._handle,  addr, ctypes.byref(data), data_len)
+
+        return data_len.value
 
-        return list(data)
+    def write_many(self, regions, control):
+        """
+        Writes several memory blocks back to back.
+        All regions are validated and converted before the first write, so an invalid region raises before the device is modified.
+
+        @param sequence regions: Sequence of (addr, data) tuples. See write() for the accepted data types.
+        @param boolean control: True for automatic control of NVMC by the function.
+        """
+        if not is_bool(control):
+            raise ValueError('The control parameter must be a boolean value.')
+
+        prepared = list()
+        for addr, data in regions:
+            if not is_u32(addr):
+                raise ValueError('The addr parameter must be an unsigned 32-bit value.')
+
+            if not is_valid_buf(data):
+                raise ValueError('The data parameter must be a sequence type with at least one item.')
+
+            data = to_c_uint8_array(data)
+            prepared.append((ctypes.c_uint32(addr), data, ctypes.c_uint32(len(data))))
+
+        control = ctypes.c_bool(control)
+        write = self._lib.NRFJPROG_write_inst
+
+        for addr, data, data_len in prepared:
+            self._call(write, self._handle, addr, ctypes.byref(data), data_len, control,
+                       err_msg='Failed to write {} bytes at address {:#010x}.'.format(data_len.value, addr.value))
+
+    def read_many(self, regions):
+        """
+        Reads several memory blocks back to back into one contiguous buffer.
+
+        @param sequence regions: Sequence of (addr, data_len) tuples.
+        @return (bytearray, [int]): Tuple containing the data of all regions in the order given, and the offset of each region in that data.
+        """
+        regions = list(regions)
+        offsets = list()
+        total_len = 0
+        for addr, data_len in regions:
+            if not is_u32(addr):
+                raise ValueError('The addr parameter must be an unsigned 32-bit value.')
+
+            if not is_u32(data_len):
+                raise ValueError('The data_len parameter must be an unsigned 32-bit value.')
+
+            offsets.append(total_len)
+            total_len += data_len
+
+        buffer = bytearray(total_len)
+        read = self._lib.NRFJPROG_read_inst
+
+        for (addr, data_len), offset in zip(regions, offsets):
+            data = (ctypes.c_uint8 * data_len).from_buffer(buffer, offset)
+            self._call(read, self._handle, ctypes.c_uint32(addr), ctypes.byref(data), ctypes.c_uint32(data_len),
+                       err_msg='Failed to read {} bytes at address {:#010x}.'.format(data_len, addr))
+
+        return buffer, offsets
 
     def is_halted(self):
         """
@@ -729,9 +791,7 @@ class API(object):
         """
         is_halted = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_halted_inst(self._handle,  ctypes.byref(is_halted))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_halted_inst, self._handle,  ctypes.byref(is_halted))
 
         return is_halted.value
 
@@ -740,9 +800,7 @@ class API(object):
         Halts the device CPU.
 
         """
-        result = self._lib.NRFJPROG_halt_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_halt_inst, self._handle)
 
     def run(self, pc, sp):
         """
@@ -760,27 +818,21 @@ class API(object):
         pc = ctypes.c_uint32(pc)
         sp = ctypes.c_uint32(sp)
 
-        result = self._lib.NRFJPROG_run_inst(self._handle,  pc, sp)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_run_inst, self._handle,  pc, sp)
 
     def go(self):
         """
         Starts the device CPU.
 
         """
-        result = self._lib.NRFJPROG_go_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_go_inst, self._handle)
 
     def step(self):
         """
         Runs the device CPU for one instruction.
 
         """
-        result = self._lib.NRFJPROG_step_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_step_inst, self._handle)
 
     def read_ram_sections_count(self):
         """
@@ -790,9 +842,7 @@ class API(object):
         """
         count = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_read_ram_sections_count_inst(self._handle,  ctypes.byref(count))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_ram_sections_count_inst, self._handle,  ctypes.byref(count))
 
         return count.value
 
@@ -805,9 +855,7 @@ class API(object):
         sections_size_list_size = ctypes.c_uint32(self.read_ram_sections_count())
         sections_size = (ctypes.c_uint32 * sections_size_list_size.value)()
 
-        result = self._lib.NRFJPROG_read_ram_sections_size_inst(self._handle,  ctypes.byref(sections_size), sections_size_list_size)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_ram_sections_size_inst, self._handle,  ctypes.byref(sections_size), sections_size_list_size)
 
         return list(sections_size)
 
@@ -820,9 +868,7 @@ class API(object):
         status_size = ctypes.c_uint32(self.read_ram_sections_count())
         status = (ctypes.c_uint32 * status_size.value)()
 
-        result = self._lib.NRFJPROG_read_ram_sections_power_status_inst(self._handle,  ctypes.byref(status), status_size)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_ram_sections_power_status_inst, self._handle,  ctypes.byref(status), status_size)
 
         return [RamPower(elem).name for elem in list(status)]
 
@@ -832,9 +878,7 @@ class API(object):
         Powers up all RAM sections of the device.
 
         """
-        result = self._lib.NRFJPROG_power_ram_all_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_power_ram_all_inst, self._handle)
 
     def unpower_ram_section(self, section_index):
         """
@@ -847,9 +891,7 @@ class API(object):
 
         section_index = ctypes.c_uint32(section_index)
 
-        result = self._lib.NRFJPROG_unpower_ram_section_inst(self._handle,  section_index)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_unpower_ram_section_inst, self._handle,  section_index)
 
     def read_memory_descriptors(self, read_page_sizes=True):
         """
@@ -860,9 +902,7 @@ class API(object):
         """
         # Start by obtaining the number of memories available
         num_available = ctypes.c_uint32()
-        result = self._lib.NRFJPROG_read_memory_descriptors_inst(self._handle, None, ctypes.c_uint32(0), ctypes.byref(num_available))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result)
+        self._call(self._lib.NRFJPROG_read_memory_descriptors_inst, self._handle, None, ctypes.c_uint32(0), ctypes.byref(num_available))
 
         # Skip read if nothing is available
         if num_available.value == 0:
@@ -870,9 +910,7 @@ class API(object):
 
         # Perform the read
         memory_description_arr = (MemoryDescriptionStruct * num_available.value)()
-        result = self._lib.NRFJPROG_read_memory_descriptors_inst(self._handle, ctypes.byref(memory_description_arr), num_available, ctypes.byref(num_available))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result)
+        self._call(self._lib.NRFJPROG_read_memory_descriptors_inst, self._handle, ctypes.byref(memory_description_arr), num_available, ctypes.byref(num_available))
 
         result = [MemoryDescription(mem_description) for mem_description in memory_description_arr[0:num_available.value]]
         if read_page_sizes:
@@ -894,9 +932,7 @@ class API(object):
 
         # Start by obtaining the number of memories available
         num_available = ctypes.c_uint32()
-        result = self._lib.NRFJPROG_read_page_sizes_inst(self._handle, ctypes.byref(memory_description._cstruct), None, ctypes.c_uint32(0), ctypes.byref(num_available))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result)
+        self._call(self._lib.NRFJPROG_read_page_sizes_inst, self._handle, ctypes.byref(memory_description._cstruct), None, ctypes.c_uint32(0), ctypes.byref(num_available))
 
         # Skip read if nothing is available
         if num_available.value == 0:
@@ -904,9 +940,7 @@ class API(object):
 
         # Perform the read
         page_repetitions_arr = (PageRepetitionsStruct * num_available.value)()
-        result = self._lib.NRFJPROG_read_page_sizes_inst(self._handle, ctypes.byref(memory_description._cstruct), ctypes.byref(page_repetitions_arr), num_available, ctypes.byref(num_available))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result)
+        self._call(self._lib.NRFJPROG_read_page_sizes_inst, self._handle, ctypes.byref(memory_description._cstruct), ctypes.byref(page_repetitions_arr), num_available, ctypes.byref(num_available))
 
         return [PageRepetitions(page_rep) for page_rep in page_repetitions_arr[0:num_available.value]]
 
@@ -927,9 +961,7 @@ class API(object):
         register_name = ctypes.c_int(register_name.value)
         value = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_read_cpu_register_inst(self._handle, register_name, ctypes.byref(value))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_cpu_register_inst, self._handle, register_name, ctypes.byref(value))
 
         return value.value
 
@@ -953,9 +985,7 @@ class API(object):
         register_name = ctypes.c_int(register_name.value)
         value = ctypes.c_uint32(value)
 
-        result = self._lib.NRFJPROG_write_cpu_register_inst(self._handle, register_name, value)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_write_cpu_register_inst, self._handle, register_name, value)
 
     def read_device_version(self):
         """
@@ -965,9 +995,7 @@ class API(object):
         """
         version = ctypes.c_int()
 
-        result = self._lib.NRFJPROG_read_device_version_inst(self._handle,  ctypes.byref(version))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_device_version_inst, self._handle,  ctypes.byref(version))
 
         return DeviceVersion(version.value).name
 
@@ -977,10 +1005,8 @@ class API(object):
         name = ctypes.c_int()
         memory = ctypes.c_int()
         revision = ctypes.c_int()
-        result = self._lib.NRFJPROG_read_device_info_inst(self._handle,  ctypes.byref(version), ctypes.byref(name),
-                               ctypes.byref(memory), ctypes.byref(revision))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_device_info_inst, self._handle,  ctypes.byref(version), ctypes.byref(name),
+                   ctypes.byref(memory), ctypes.byref(revision))
 
         return DeviceVersion(version.value), DeviceName(name.value), DeviceMemory(memory.value), DeviceRevision(
             revision.value)
@@ -993,9 +1019,7 @@ class API(object):
         """
         family = ctypes.c_int()
 
-        result = self._lib.NRFJPROG_read_device_family_inst(self._handle,  ctypes.byref(family))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_device_family_inst, self._handle,  ctypes.byref(family))
 
         return DeviceFamily(family.value).name
 
@@ -1012,9 +1036,7 @@ class API(object):
         addr = ctypes.c_uint8(addr)
         data = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_read_debug_port_register_inst(self._handle,  addr, ctypes.byref(data))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_debug_port_register_inst, self._handle,  addr, ctypes.byref(data))
 
         return data.value
 
@@ -1034,9 +1056,7 @@ class API(object):
         addr = ctypes.c_uint8(addr)
         data = ctypes.c_uint32(data)
 
-        result = self._lib.NRFJPROG_write_debug_port_register_inst(self._handle,  addr, data)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_write_debug_port_register_inst, self._handle,  addr, data)
 
     def read_access_port_register(self, ap_index, addr):
         """
@@ -1056,9 +1076,7 @@ class API(object):
         addr = ctypes.c_uint8(addr)
         data = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_read_access_port_register_inst(self._handle,  ap_index, addr, ctypes.byref(data))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_access_port_register_inst, self._handle,  ap_index, addr, ctypes.byref(data))
 
         return data.value
 
@@ -1083,9 +1101,7 @@ class API(object):
         addr = ctypes.c_uint8(addr)
         data = ctypes.c_uint32(data)
 
-        result = self._lib.NRFJPROG_write_access_port_register_inst(self._handle,  ap_index, addr, data)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_write_access_port_register_inst, self._handle,  ap_index, addr, data)
 
     def is_rtt_started(self):
         """
@@ -1095,9 +1111,7 @@ class API(object):
         """
         started = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_rtt_started_inst(self._handle,  ctypes.byref(started))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_rtt_started_inst, self._handle,  ctypes.byref(started))
 
         return started.value
 
@@ -1112,18 +1126,14 @@ class API(object):
 
         addr = ctypes.c_uint32(addr)
 
-        result = self._lib.NRFJPROG_rtt_set_control_block_address_inst(self._handle,  addr)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_rtt_set_control_block_address_inst, self._handle,  addr)
 
     def rtt_start(self):
         """
         Starts RTT.
 
         """
-        result = self._lib.NRFJPROG_rtt_start_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_rtt_start_inst, self._handle)
 
     def rtt_is_control_block_found(self):
         """
@@ -1133,9 +1143,7 @@ class API(object):
         """
         is_control_block_found = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_rtt_is_control_block_found_inst(self._handle,  ctypes.byref(is_control_block_found))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_rtt_is_control_block_found_inst, self._handle,  ctypes.byref(is_control_block_found))
 
         return is_control_block_found.value
 
@@ -1144,9 +1152,7 @@ class API(object):
         Stops RTT.
 
         """
-        result = self._lib.NRFJPROG_rtt_stop_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_rtt_stop_inst, self._handle)
 
     def rtt_read(self, channel_index, length, encoding='utf-8'):
         """
@@ -1166,30 +1172,48 @@ class API(object):
         if encoding is not None and not is_valid_encoding(encoding):
             raise ValueError('The encoding parameter must be either None or a standard encoding in python.')
 
-        channel_index = ctypes.c_uint32(channel_index)
-        length = ctypes.c_uint32(length)
-        data = (ctypes.c_uint8 * length.value)()
-        data_read = ctypes.c_uint32()
-
-        result = self._lib.NRFJPROG_rtt_read_inst(self._handle,  channel_index, ctypes.byref(data), length, ctypes.byref(data_read))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        data = bytearray(length)
+        del data[self.rtt_read_into(channel_index, data):]
 
         if encoding is None:
-            return bytearray(data[0:data_read.value])
+            return data
         else:
             if sys.version_info[0] == 2:
-                return bytearray(data[0:data_read.value]).decode(encoding).encode('utf-8')
+                return data.decode(encoding).encode('utf-8')
             else:
-                return bytearray(data[0:data_read.value]).decode(encoding)
+                return data.decode(encoding)
+
+    def rtt_read_into(self, channel_index, buffer):
+        """
+        Reads from an RTT channel into a caller-owned buffer.
+        The buffer is filled in place, so the same buffer can be reused for repeated reads without allocating new memory.
+
+        @param int channel_index: RTT channel to read.
+        @param buffer buffer: Writable buffer (i.e. bytearray, memoryview, array...) to read into. Its size in bytes is the maximum number of bytes to read.
+        @return int: Number of bytes read. Only the first bytes of the buffer up to this count are updated.
+        """
+        if not is_u32(channel_index):
+            raise ValueError('The channel_index parameter must be an unsigned 32-bit value.')
+
+        if not is_writable_buf(buffer):
+            raise ValueError('The buffer parameter must be a writable and contiguous buffer.')
+
+        channel_index = ctypes.c_uint32(channel_index)
+        data = to_c_uint8_array(buffer)
+        length = ctypes.c_uint32(len(data))
+        data_read = ctypes.c_uint32()
+
+        self._call(self._lib.NRFJPROG_rtt_read_inst, self._handle,  channel_index, ctypes.byref(data), length, ctypes.byref(data_read))
+
+        return data_read.value
 
     def rtt_write(self, channel_index, msg, encoding='utf-8'):
         """
         Writes to an RTT channel.
 
         @param int channel_index: RTT channel to write.
-        @param sequence msg: Data to write. Any type that implements the sequence API (i.e. string, list, bytearray...) is valid as input.
-        @param (optional) str or None encoding: Encoding of the msg to write. Default value 'utf-8'.
+        @param str, buffer or sequence msg: Data to write. A string is encoded with encoding, buffers (bytes, bytearray, memoryview...) and sequences of uint8 values are passed as they are, see to_c_uint8_array().
+        @param (optional) str or None encoding: Encoding of a string msg. Default value 'utf-8'.
         @return int: Number of bytes written.  Note that if non-'latin-1' characters are used, the number of bytes written depends on the encoding parameter given.
         """
         if not is_u32(channel_index):
@@ -1198,19 +1222,18 @@ class API(object):
         if encoding is not None and not is_valid_encoding(encoding):
             raise ValueError('The encoding parameter must be either None or a standard encoding in python.')
 
-        msg = bytearray(msg.encode(encoding)) if encoding else bytearray(msg)
+        if encoding and isinstance(msg, str):
+            msg = msg.encode(encoding)
         if not is_valid_buf(msg):
             raise ValueError('The msg parameter must be a sequence type with at least one item.')
 
         channel_index = ctypes.c_uint32(channel_index)
-        length = ctypes.c_uint32(len(msg))
-        data = (ctypes.c_uint8 * length.value)(*msg)
+        data = to_c_uint8_array(msg)
+        length = ctypes.c_uint32(len(data))
         data_written = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_rtt_write_inst(self._handle,  channel_index, ctypes.byref(data), length,
-                               ctypes.byref(data_written))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_rtt_write_inst, self._handle,  channel_index, ctypes.byref(data), length,
+                   ctypes.byref(data_written))
 
         return data_written.value
 
@@ -1223,10 +1246,8 @@ class API(object):
         down_channel_number = ctypes.c_uint32()
         up_channel_number = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_rtt_read_channel_count_inst(self._handle,  ctypes.byref(down_channel_number),
-                               ctypes.byref(up_channel_number))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_rtt_read_channel_count_inst, self._handle,  ctypes.byref(down_channel_number),
+                   ctypes.byref(up_channel_number))
 
         return down_channel_number.value, up_channel_number.value
 
@@ -1254,10 +1275,8 @@ class API(object):
         name = (ctypes.c_uint8 * 32)()
         size = ctypes.c_uint32()
 
-        result = self._lib.NRFJPROG_rtt_read_channel_info_inst(self._handle,  channel_index, direction, ctypes.byref(name), name_len,
-                               ctypes.byref(size))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_rtt_read_channel_info_inst, self._handle,  channel_index, direction, ctypes.byref(name), name_len,
+                   ctypes.byref(size))
 
         return ''.join(chr(i) for i in name if i != 0), size.value
 
@@ -1269,9 +1288,7 @@ class API(object):
         """
         initialized = ctypes.c_bool()
 
-        result = self._lib.NRFJPROG_is_qspi_init_inst(self._handle,  ctypes.byref(initialized))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_is_qspi_init_inst, self._handle,  ctypes.byref(initialized))
 
         return initialized.value
 
@@ -1344,9 +1361,7 @@ class API(object):
             init_params.pp_size
         )
 
-        result = self._lib.NRFJPROG_qspi_init_inst(self._handle,  retain_ram, ctypes.byref(qspi_init_params))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_init_inst, self._handle,  retain_ram, ctypes.byref(qspi_init_params))
 
     def qspi_init_ini(self, ini_path=QSPIIniFile):
         """
@@ -1356,9 +1371,7 @@ class API(object):
         @param Path ini_path: Path to ini file containing qspi setup.
         """
         ini_path = str(ini_path).encode('utf-8')
-        result = self._lib.NRFJPROG_qspi_init_ini_inst(self._handle, ini_path)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_init_ini_inst, self._handle, ini_path)
 
     def qspi_start(self):
         """
@@ -1366,9 +1379,7 @@ class API(object):
         QSPI peripheral must be configured before calling this function, see functions 'qspi_configure' and 'qspi_configure_ini'.
         The QSPi peripheral can be configured and initialized in the same operation using functions 'qspi_init' or 'qspi_init_ini'.
         """
-        result = self._lib.NRFJPROG_qspi_start_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_start_inst, self._handle)
 
     def qspi_configure(self, retain_ram=False, init_params=None):
         """
@@ -1438,9 +1449,7 @@ class API(object):
             init_params.pp_size
         )
 
-        result = self._lib.NRFJPROG_qspi_configure_inst(self._handle,  retain_ram, ctypes.byref(qspi_init_params))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_configure_inst, self._handle,  retain_ram, ctypes.byref(qspi_init_params))
 
     def qspi_configure_ini(self, ini_path=QSPIIniFile):
         """
@@ -1450,18 +1459,14 @@ class API(object):
         @param Path ini_path: Path to ini file containing qspi setup.
         """
         ini_path = str(ini_path).encode('utf-8')
-        result = self._lib.NRFJPROG_qspi_configure_ini_inst(self._handle, ini_path)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_configure_ini_inst, self._handle, ini_path)
 
     def qspi_uninit(self):
         """
         Uninitializes the QSPI peripheral.
         
         """
-        result = self._lib.NRFJPROG_qspi_uninit_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_uninit_inst, self._handle)
 
     def qspi_set_rx_delay(self, rx_delay):
         """
@@ -1475,9 +1480,7 @@ class API(object):
 
         rx_delay = ctypes.c_uint8(rx_delay)
 
-        result = self._lib.NRFJPROG_qspi_set_rx_delay_inst(self._handle,  rx_delay)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_set_rx_delay_inst, self._handle,  rx_delay)
 
     def qspi_set_size(self, size):
         """
@@ -1489,18 +1492,14 @@ class API(object):
             raise ValueError("The size parameter must be an unsigned 32-bit value")
 
         size = ctypes.c_uint32(size)
-        result = self._lib.NRFJPROG_qspi_set_size_inst(self._handle, size)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_set_size_inst, self._handle, size)
 
     def qspi_get_size(self):
         """
         Get previously configured QSPI size.
         """
         size = ctypes.c_uint32(0)
-        result = self._lib.NRFJPROG_qspi_get_size_inst(self._handle, ctypes.byref(size))
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_get_size_inst, self._handle, ctypes.byref(size))
 
         return size.value
 
@@ -1518,22 +1517,39 @@ class API(object):
         if not is_u32(length):
             raise ValueError('The length parameter must be an unsigned 32-bit value.')
 
+        data = bytearray(length)
+        self.qspi_read_into(addr, data)
+        return data
+
+    def qspi_read_into(self, addr, buffer):
+        """
+        Reads from the external QSPI-connected memory into a caller-owned buffer.
+        The buffer is filled in place, so the same buffer can be reused for repeated reads without allocating new memory.
+
+        @param int addr: Address to read from.
+        @param buffer buffer: Writable buffer (i.e. bytearray, memoryview, array...) to read into. Its size in bytes is the number of bytes to read.
+        @return int: Number of bytes read.
+        """
+        if not is_u32(addr):
+            raise ValueError('The addr parameter must be an unsigned 32-bit value.')
+
+        if not is_writable_buf(buffer):
+            raise ValueError('The buffer parameter must be a writable and contiguous buffer.')
+
         addr = ctypes.c_uint32(addr)
-        length = ctypes.c_uint32(length)
-        data = (ctypes.c_uint8 * length.value)()
+        data = to_c_uint8_array(buffer)
+        length = ctypes.c_uint32(len(data))
 
-        result = self._lib.NRFJPROG_qspi_read_inst(self._handle,  addr, ctypes.byref(data), length)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_read_inst, self._handle,  addr, ctypes.byref(data), length)
 
-        return bytearray(data)
+        return length.value
 
     def qspi_write(self, addr, data):
         """
         Writes to the external QSPI-connected memory.
         
         @param int addr: Address to write to.
-        @param sequence data: Data to write. Any type that implements the sequence API (i.e. string, list, bytearray...) is valid as input.
+        @param sequence data: Data to write. Any object supporting the buffer protocol (i.e. bytes, bytearray, memoryview...) or sequence of uint8 values (i.e. list, tuple...) is valid as input.
         """
         if not is_u32(addr):
             raise ValueError('The addr parameter must be an unsigned 32-bit value.')
@@ -1542,12 +1558,10 @@ class API(object):
             raise ValueError('The data parameter must be a sequence type with at least one item.')
 
         addr = ctypes.c_uint32(addr)
+        data = to_c_uint8_array(data)
         data_len = ctypes.c_uint32(len(data))
-        data = (ctypes.c_uint8 * data_len.value)(*data)
 
-        result = self._lib.NRFJPROG_qspi_write_inst(self._handle,  addr, ctypes.byref(data), data_len)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_write_inst, self._handle,  addr, ctypes.byref(data), data_len)
 
     def qspi_erase(self, addr, length):
         """
@@ -1569,9 +1583,7 @@ class API(object):
         addr = ctypes.c_uint32(addr)
         length = ctypes.c_int(length)
 
-        result = self._lib.NRFJPROG_qspi_erase_inst(self._handle,  addr, length)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_erase_inst, self._handle,  addr, length)
 
     def qspi_custom(self, code, length, data_in=None, output=False):
         """
@@ -1600,16 +1612,14 @@ class API(object):
         data_in = (ctypes.c_uint8 * (length.value - 1))(*data_in) if data_in is not None else None
         data_out = (ctypes.c_uint8 * (length.value - 1))() if output else None
 
-        result = self._lib.NRFJPROG_qspi_custom_inst(self._handle,  code, length,
-                               ctypes.byref(data_in) if data_in is not None else None,
-                               ctypes.byref(data_out) if data_out is not None else None)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_qspi_custom_inst, self._handle,  code, length,
+                   ctypes.byref(data_in) if data_in is not None else None,
+                   ctypes.byref(data_out) if data_out is not None else None)
 
         if output:
             return bytearray(data_out)
 
-    def program_file(self, file_path):
+    def program_file(self, file_path, progress=None):
         """
         Programs provided file to connected device.
         The device memory is not checked before or after writing. To ensure flash is empty before writing use
@@ -1620,11 +1630,11 @@ class API(object):
         This function can be used to upgrade modem firmware on nRF91 devices by passing pa
 
         @param Path file_path : Path to file to program.
+        @param (optional) callable progress: Called with Progress.ProgressEvent objects while programming, see Progress.py. The events between start and end need the DLL messages, which are not received when the api is constructed with dll_messages=False and logging disabled.
         """
-        file_path = str(file_path).encode('utf-8')
-        result = self._lib.NRFJPROG_program_file_inst(self._handle, file_path)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        with Progress.track(self._logger, progress, 'program', file_path):
+            file_path = str(file_path).encode('utf-8')
+            self._call(self._lib.NRFJPROG_program_file_inst, self._handle, file_path)
 
     def read_to_file(self, file_path, read_options=None):
         """
@@ -1641,9 +1651,7 @@ class API(object):
         if not isinstance(read_options, ReadOptions):
             raise TypeError('The program_options parameter must be an instance of class ReadOptions.')
 
-        result = self._lib.NRFJPROG_read_to_file_inst(self._handle, file_path, read_options)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_read_to_file_inst, self._handle, file_path, read_options)
 
     def verify_file(self, file_path, verify_action=VerifyAction.VERIFY_READ):
         """
@@ -1661,9 +1669,7 @@ class API(object):
 
         file_path = str(file_path).encode('utf-8')
 
-        result = self._lib.NRFJPROG_verify_file_inst(self._handle, file_path, verify_action)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_verify_file_inst, self._handle, file_path, verify_action)
 
     def erase_file(self, file_path, chip_erase_mode=EraseAction.ERASE_ALL, qspi_erase_mode=EraseAction.ERASE_NONE):
         """
@@ -1684,9 +1690,7 @@ class API(object):
         chip_erase_mode = ctypes.c_int(decode_enum(chip_erase_mode, EraseAction))
         qspi_erase_mode = ctypes.c_int(decode_enum(qspi_erase_mode, EraseAction))
 
-        result = self._lib.NRFJPROG_erase_file_inst(self._handle, file_path, chip_erase_mode, qspi_erase_mode)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_erase_file_inst, self._handle, file_path, chip_erase_mode, qspi_erase_mode)
 
     # if colored(INTERNAL)
     def masserase(self):
@@ -1694,9 +1698,7 @@ class API(object):
         Erases all flash, including the info pages.
 
         """
-        result = self._lib.NRFJPROG_masserase_inst(self._handle)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_masserase_inst, self._handle)
 
     def ficrwrite_u32(self, addr, data):
         """
@@ -1714,16 +1716,14 @@ class API(object):
         addr = ctypes.c_uint32(addr)
         data = ctypes.c_uint32(data)
 
-        result = self._lib.NRFJPROG_ficrwrite_u32_inst(self._handle,  addr, data)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_ficrwrite_u32_inst, self._handle,  addr, data)
 
     def ficrwrite(self, addr, data):
         """
         Writes data from the array into the device starting at the given address in the FICR.
 
         @param int addr: Start address of the memory block to write.
-        @param sequence data: Data to write. Any type that implements the sequence API (i.e. string, list, bytearray...) is valid as input.
+        @param sequence data: Data to write. Any object supporting the buffer protocol (i.e. bytes, bytearray, memoryview...) or sequence of uint8 values (i.e. list, tuple...) is valid as input.
         """
         if not is_u32(addr):
             raise ValueError('The addr parameter must be an unsigned 32-bit value.')
@@ -1732,12 +1732,10 @@ class API(object):
             raise ValueError('The data parameter must be a tuple or a list with at least one item.')
 
         addr = ctypes.c_uint32(addr)
+        data = to_c_uint8_array(data)
         data_len = ctypes.c_uint32(len(data))
-        data = (ctypes.c_uint8 * data_len.value)(*data)
 
-        result = self._lib.NRFJPROG_ficrwrite_inst(self._handle,  addr, ctypes.byref(data), data_len)
-        if result != NrfjprogdllErr.SUCCESS:
-            raise APIError(result, error_data=self.get_errors())
+        self._call(self._lib.NRFJPROG_ficrwrite_inst, self._handle,  addr, ctypes.byref(data), data_len)
 
     # endif /* colored(INTERNAL) */
 
@@ -1,7 +1,10 @@
 
 from __future__ import print_function
 
+import collections
+import itertools
 import logging
+import threading
 import time
 from builtins import int
 
@@ -42,24 +45,98 @@ class CallbackHandler(logging.Handler):
         self.callback(record)
 
 class ErrorHandler(logging.Handler):
-    def __init__(self):
+    """
+    Keeps the last error records reported by the DLL in a fixed-capacity ring.
+    Records are numbered in arrival order, so that a caller can collect only the records of its own operation.
+    """
+
+    def __init__(self, capacity=64):
         super(ErrorHandler, self).__init__()
-        self.errors = list()
+        self.errors = collections.deque(maxlen=capacity)
         self.setLevel(logging.ERROR)
 
+        # Notified on every error record, so that take_errors() returns as soon as the DLL has reported its error.
+        self._arrived = threading.Condition()
+        # Sequence number of the next record, and of the first record of the current error scope.
+        self._next_sequence = 0
+        self._scope_start = 0
+
+    @property
+    def sequence(self):
+        """ Sequence number that the next error record will get. Read before every DLL call, so it takes no lock. """
+        return self._next_sequence
+
     def emit(self, record):
-        self.errors.append(record)
+        # Errors logged from Python, i.e. by APIError(log=...), are echoes of errors that were already reported.
+        if not getattr(record, 'from_dll', False):
+            return
+
+        with self._arrived:
+            self.errors.append((self._next_sequence, record))
+            self._next_sequence += 1
+            self._arrived.notify_all()
+
+    def take_errors(self, timeout, since=None, quiet_interval=0.0):
+        """
+        Returns the error records reported by the DLL in the current error scope, and starts a new error scope.
+
+        An error can be reported in several records, which may arrive after the failing function returned. Once the scope
+        has a record, wait until no record arrives for quiet_interval, so that the whole error is taken.
+
+        @param float timeout: Maximum time in seconds to wait for the records.
+        @param (optional) int since: Sequence number where the scope starts, i.e. taken from sequence before an operation. Defaults to the end of the previous scope.
+        @param (optional) float quiet_interval: Time in seconds without new records after which the error is complete.
+        @return [logging.LogRecord]: Records reported by the DLL. Records that were pushed out of the ring are not included.
+        """
+        with self._arrived:
+            start = self._scope_start if since is None else since
+            deadline = time.monotonic() + timeout
+            if self._arrived.wait_for(lambda: self._next_sequence > start, timeout):
+                while True:
+                    seen = self._next_sequence
+                    remaining = deadline - time.monotonic()
+                    if remaining <= 0 or not self._arrived.wait_for(lambda: self._next_sequence > seen, min(quiet_interval, remaining)):
+                        break
+            records = [record for sequence, record in self.errors if sequence >= start]
+            self._scope_start = self._next_sequence
+        return records
+
+
+class InstanceLogger(logging.Logger):
+    """
+    Logger owned by one API or probe instance.
+    It is not registered with the logging module, so that it is freed together with its instance, and its records
+    propagate to the module logger given as parent.
+    """
+    _instance_count = itertools.count()
+
+    def __init__(self, parent):
+        super(InstanceLogger, self).__init__('{}.{}'.format(parent.name, next(self._instance_count)))
+        self.parent = parent
+
+    def isEnabledFor(self, level):
+        # The logging module only clears the level cache of registered loggers, so do not cache the result.
+        if self.disabled or self.manager.disable >= level:
+            return False
+        return level >= self.getEffectiveLevel()
 
 
 class LoggerAdapter(logging.LoggerAdapter):
-    def __init__(self, logger, id, log=None, log_str_cb=None, log_str=None,  log_file_path=None, log_stringio=None):
+    # Maximum time in seconds get_errors() waits for the DLL to report the error of a failed function.
+    ERROR_FLUSH_TIMEOUT = 0.5
+    # Time in seconds without new error messages after which get_errors() considers the error complete.
+    ERROR_QUIET_INTERVAL = 0.005
+
+    def __init__(self, logger, id, log=None, log_str_cb=None, log_str=None,  log_file_path=None, log_stringio=None,
+                 dll_messages=True):
         """
         Setup API's debug output logging mechanism.
+        Handlers are added to a child logger of logger owned by this adapter, so instances do not see each other's records.
+        If dll_messages is False and logging is disabled, the DLL messages are not passed to Python at all, see log_cb.
 
         """
-        super(LoggerAdapter, self).__init__(logger, id)
+        super(LoggerAdapter, self).__init__(InstanceLogger(logger), id)
 
-        self.log_cb = None
         self.error_handler = ErrorHandler()
         self.logger.addHandler(self.error_handler)
 
@@ -89,18 +166,81 @@ class LoggerAdapter(logging.LoggerAdapter):
                 for handler in self.logger.handlers:
                     handler.setFormatter(formatter)
 
-            self.log_cb = ctypes.CFUNCTYPE(None, ctypes.c_char_p, ctypes.c_int, ctypes.c_char_p, ctypes.c_void_p)\
-                (
-                    lambda logger_name, level, msg_str, instance:
-                        self.log_function(decode_string(logger_name).strip(), level, decode_string(msg_str).strip())
-                )
+        # (level, callable) pairs receiving DLL messages whether or not logging is enabled. Replaced, never modified,
+        # so the DLL callback can iterate it without a lock.
+        self._listeners = tuple()
+        # Lowest level of the listeners, above any level when there is no listener.
+        self._listener_level = logging.CRITICAL + 1
+
+        # The strings are passed as raw pointers so that they are only copied for messages that are used.
+        self._log_cb = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p, ctypes.c_void_p)(self._dll_log_callback)
+        self._dll_messages = dll_messages
+        # True once log_cb has been given to the DLL.
+        self.receives_dll_messages = False
+
+    @property
+    def log_cb(self):
+        """
+        Callback to pass to the DLL when the instance is opened. The callback drops the messages nobody uses before decoding
+        them, so it is given by default, and listeners such as progress trackers added after open receive the messages.
+        It is None if dll_messages is False and neither logging nor a listener uses the messages, so that the DLL does not
+        call into Python for each message. The DLL keeps the callback it is given when opened, so such an instance never
+        receives messages.
+        """
+        self.receives_dll_messages = self._dll_messages or not self.logger.disabled or bool(self._listeners)
+        return self._log_cb if self.receives_dll_messages else None
 
     def set_id(self, id):
         self.extra = id
 
+    def close(self):
+        """
+        Flushes and closes the handlers, releasing log files. The handlers stay attached, and a FileHandler reopens its
+        file in append mode if the instance logs again.
+        """
+        for handler in self.logger.handlers:
+            handler.flush()
+            handler.close()
+
+    def add_listener(self, listener, level=logging.INFO):
+        """
+        Adds a listener of the DLL messages. Listeners are called from the thread running the DLL function.
+
+        @param callable listener: Called as listener(level, message) for each DLL message of at least level, with the logging level and the message text.
+        @param (optional) int level: Minimum logging level of the messages passed to the listener.
+        """
+        self._set_listeners(self._listeners + ((level, listener),))
+
+    def remove_listener(self, listener):
+        """
+        Removes a listener added with add_listener().
+        """
+        self._set_listeners(tuple(entry for entry in self._listeners if entry[1] != listener))
+
+    def _set_listeners(self, listeners):
+        self._listener_level = min([level for level, _ in listeners], default=logging.CRITICAL + 1)
+        self._listeners = listeners
+
+    def _dll_log_callback(self, logger_name, level, msg_str, instance):
+        # Most DLL messages are debug and trace messages, drop them before decoding when nobody uses them.
+        level = DLL_LOG_LEVELS.get(level, logging.NOTSET)
+        log = self.isEnabledFor(level)
+        if not log and level < self._listener_level:
+            return
+
+        logger_name = decode_string(ctypes.string_at(logger_name)).strip()
+        msg_str = decode_string(ctypes.string_at(msg_str)).strip()
+
+        for listener_level, listener in self._listeners:
+            if level >= listener_level:
+                listener(level, msg_str)
+
+        if log:
+            self.log(level, f"[{logger_name}] {msg_str}", extra={'from_dll': True})
+
     def log_function(self, logger_name, level, msg_str):
         msg = f"[{logger_name}] {msg_str}"
-        self.log(NrfjrpogdllLogLevel.get_level_from_value(level), msg)
+        self.log(NrfjrpogdllLogLevel.get_level_from_value(level), msg, extra={'from_dll': True})
 
     def process(self, msg, kwargs):
         if self.extra is not None:
@@ -108,11 +248,25 @@ class LoggerAdapter(logging.LoggerAdapter):
         else:
             return msg, kwargs
 
-    def get_errors(self):
-        # Sleep 500 milliseconds so that any pending log messages can propagate to the logger.
-        time.sleep(.5)
+    def get_errors(self, since=None):
+        """
+        Returns the error messages reported by the DLL since the previous call, or since the error sequence number since.
+
+        The DLL may deliver its log messages after the failing function has returned. Wait until an error has been reported
+        and no further message arrives for ERROR_QUIET_INTERVAL, for at most ERROR_FLUSH_TIMEOUT seconds. When logging is
+        disabled no error is recorded, so return at once.
+        """
+        timeout = self.ERROR_FLUSH_TIMEOUT if not self.logger.disabled else 0
         formatter = logging.Formatter("%(message)s")
-        return [formatter.format(record) for record in self.error_handler.errors]
+        records = self.error_handler.take_errors(timeout, since, self.ERROR_QUIET_INTERVAL)
+        return [formatter.format(record) for record in records]
+
+    def error_sequence(self):
+        """
+        Returns the sequence number of the next error reported by the DLL. Taken before each DLL call and passed to
+        get_errors() if the call fails, so that the errors of the call are reported, and not those of earlier calls.
+        """
+        return self.error_handler.sequence
 
 ###################################################################################
 #                                                                                 #
@@ -133,13 +287,64 @@ def is_bool(value):
     return isinstance(value, bool) or 0 <= value <= 1
 
 
+def is_buffer(value):
+    """ Returns True if value supports the buffer protocol (bytes, bytearray, memoryview, array, mmap...). """
+    try:
+        memoryview(value)
+    except TypeError:
+        return False
+    return True
+
+
 def is_valid_buf(buf):
-    if buf is None:
+    """
+    Returns True if buf holds at least one byte of data.
+    Buffers are accepted in constant time. Other sequences are checked by the bytearray constructor, which rejects items
+    that are not integers in range(256) without running a Python loop per item.
+    """
+    if buf is None or isinstance(buf, (int, str)):
         return False
-    for value in buf:
-        if not is_u8(value):
-            return False
-    return len(buf) > 0
+    if is_buffer(buf):
+        return memoryview(buf).nbytes > 0
+    try:
+        return len(buf) > 0 and len(bytearray(buf)) > 0
+    except (TypeError, ValueError):
+        return False
+
+
+def is_writable_buf(buf):
+    """ Returns True if buf is a writable, contiguous buffer that the DLL can fill in place. """
+    try:
+        view = memoryview(buf)
+    except TypeError:
+        return False
+    return not view.readonly and view.c_contiguous
+
+
+def to_c_uint8_array(data):
+    """
+    Converts data to a ctypes uint8 array that can be passed to the nrfjprog DLL.
+
+    Writable buffers (bytearray, writable memoryview, array, mmap...) are shared with the returned array without copying,
+    read-only buffers (bytes, read-only memoryview...) are copied in one block, and other sequences of uint8 values are converted by
+    the bytearray constructor.
+    Buffers are passed as raw memory, so an array('I') of n items is passed as 4 * n bytes.
+
+    @param sequence or buffer data: Data to convert.
+    @return ctypes.c_uint8 array: Array holding the data.
+    """
+    try:
+        view = memoryview(data)
+    except TypeError:
+        view = memoryview(bytearray(data))
+
+    if not view.c_contiguous:
+        view = memoryview(view.tobytes())
+    view = view.cast('B')
+
+    if view.readonly:
+        return (ctypes.c_uint8 * view.nbytes).from_buffer_copy(view)
+    return (ctypes.c_uint8 * view.nbytes).from_buffer(view)
 
 
 def is_valid_encoding(encoding):
@@ -401,22 +606,19 @@ class NrfjrpogdllLogLevel(enum.IntEnum):
 
     @staticmethod
     def get_level_from_value(level):
-        if level == NrfjrpogdllLogLevel.critical:
-            return logging.CRITICAL
-        elif level == NrfjrpogdllLogLevel.error:
-            return logging.ERROR
-        elif level == NrfjrpogdllLogLevel.warning:
-            return logging.WARNING
-        elif level == NrfjrpogdllLogLevel.info:
-            return logging.INFO
-        elif level == NrfjrpogdllLogLevel.debug:
-            return logging.DEBUG
-        elif level == NrfjrpogdllLogLevel.trace:
-            return logging.DEBUG
-        elif level == NrfjrpogdllLogLevel.none:
-            return logging.NOTSET
-        else:
-            return logging.NOTSET
+        return DLL_LOG_LEVELS.get(level, logging.NOTSET)
+
+
+# Logging level of each nrfjprogdll_log_level value.
+DLL_LOG_LEVELS = {
+    NrfjrpogdllLogLevel.critical: logging.CRITICAL,
+    NrfjrpogdllLogLevel.error: logging.ERROR,
+    NrfjrpogdllLogLevel.warning: logging.WARNING,
+    NrfjrpogdllLogLevel.info: logging.INFO,
+    NrfjrpogdllLogLevel.debug: logging.DEBUG,
+    NrfjrpogdllLogLevel.trace: logging.DEBUG,
+    NrfjrpogdllLogLevel.none: logging.NOTSET,
+}
 
 
 ###################################################################################
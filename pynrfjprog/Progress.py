@@ -0,0 +1,251 @@
+"""
+This module turns the progress messages logged by the nrfjprog DLLs into structured progress events.
+
+The DLLs no longer call progress callbacks. They log info messages instead, such as "Erasing flash range [...]" or
+"Uploading chunk offset: ..., len: ..., out of total len ...". A ProgressTracker listens to these messages on the
+LoggerAdapter of an API or probe and reports ProgressEvent objects with the bytes done, the total and the throughput.
+
+Functions that take a progress parameter (HighLevel.Probe.program, verify and erase, LowLevel.API.program_file) call
+it with a 'start' event, 'progress' events while the DLL reports progress, and an 'end' event when the function succeeds.
+The DLL messages are received by default. Instances constructed with dll_messages=False and logging disabled do not
+receive them, see Parameters.LoggerAdapter.log_cb, and only report the start and end events, with a warning.
+
+Example:
+    probe.program('image.hex', progress=lambda event: print(event))
+
+    for event in Progress.iter_progress(probe.program, 'image.hex'):
+        print(event.phase, event.done, event.total, event.average_rate)
+"""
+
+from __future__ import print_function
+
+import contextlib
+import logging
+import os
+import queue
+import re
+import threading
+import time
+import warnings
+
+try:
+    from . import Hex
+except Exception:
+    import Hex
+
+
+class ProgressEvent(object):
+    """ Progress of a programming, verify or erase operation. Sizes are in bytes and rates in bytes per second. """
+    __slots__ = ('state', 'phase', 'done', 'total', 'rate', 'average_rate', 'elapsed', 'message')
+
+    def __init__(self, state, phase, done, total, rate, average_rate, elapsed, message=None):
+        # 'start', 'progress' or 'end'.
+        self.state = state
+        # 'erase', 'program' or 'verify'. The phase can change during an operation, i.e. when programming erases first.
+        self.phase = phase
+        # Bytes processed in the current phase, None if the DLL does not report it.
+        self.done = done
+        # Total bytes of the current phase, None if unknown.
+        self.total = total
+        # Throughput since the previous event of the phase, None if unknown.
+        self.rate = rate
+        # Throughput since the start of the phase, None if unknown.
+        self.average_rate = average_rate
+        # Seconds since the start of the phase.
+        self.elapsed = elapsed
+        # DLL message the event was parsed from, None for start and end events.
+        self.message = message
+
+    def __repr__(self):
+        return "ProgressEvent({}, {}, {}/{}, rate={}, average_rate={}, elapsed={:.3f}s)".format(
+            self.state, self.phase, self.done, self.total, self.rate, self.average_rate, self.elapsed)
+
+
+def image_size(file_path):
+    """
+    Returns the number of data bytes of an image file, or None for file types whose size is not known without the DLL.
+
+    @param str file_path: Path to a .hex or .bin file.
+    @return int: Number of bytes.
+    """
+    extension = os.path.splitext(str(file_path))[1].lower()
+    if extension == '.bin':
+        return os.path.getsize(str(file_path))
+    if extension == '.hex':
+        # Large chunks, as only their sizes are used.
+        return sum(len(chunk.data) for chunk in Hex.iter_hex_chunks(str(file_path), 0x100000))
+    return None
+
+
+_PHASE_MESSAGES = (
+    (re.compile(r'^(Erasing|Erase)\b'), 'erase'),
+    (re.compile(r'^(Programming|Program|Uploading image)\b'), 'program'),
+    (re.compile(r'^(Verifying|Verify)\b'), 'verify'),
+)
+
+
+def phase_of(message):
+    """
+    Returns the phase started by a DLL message.
+
+    @param str message: DLL log message.
+    @return str: 'erase', 'program' or 'verify', None if the message does not start a phase.
+    """
+    for pattern, phase in _PHASE_MESSAGES:
+        if pattern.search(message):
+            return phase
+    return None
+
+
+class ProgressTracker(object):
+    """
+    Parses the DLL messages of one operation into ProgressEvent objects.
+    """
+
+    # Messages reporting bytes done and total.
+    _CHUNK = re.compile(r'Uploading chunk offset: (\d+), len: (\d+), out of total len (\d+)')
+    # Messages reporting an erased range, which adds to the bytes done.
+    _ERASE_RANGE = re.compile(r'Erasing flash range \[(0x[0-9a-fA-F]+)-(0x[0-9a-fA-F]+)\]')
+    # Messages reporting a count of blocks or ranges, scaled to the total bytes when it is known.
+    _COUNT = re.compile(r'(?:Loaded block|Verifying memory range) (\d+) of (\d+)')
+
+    def __init__(self, callback, phase, total=None):
+        """
+        @param callable callback: Called with each ProgressEvent.
+        @param str phase: Phase of the operation when it starts.
+        @param (optional) int total: Total bytes of the operation, if known.
+        """
+        self._callback = callback
+        # The total applies to the phase the operation starts with, i.e. not to the erase done while programming.
+        self._initial_phase = phase
+        self._total = total
+        self._start_phase(phase)
+
+    def _start_phase(self, phase):
+        # Erased bytes are counted from the erased ranges, the other phases only report bytes done in some messages.
+        self._done = 0 if phase == 'erase' else None
+        self._phase_total = self._total if phase == self._initial_phase else None
+        self._phase = phase
+        self._phase_start = self._last_time = time.perf_counter()
+        self._last_done = 0
+
+    def _emit(self, state, message=None):
+        now = time.perf_counter()
+        elapsed = now - self._phase_start
+        rate = None
+        average_rate = None
+        if self._done is not None:
+            if now > self._last_time and self._done >= self._last_done:
+                rate = (self._done - self._last_done) / (now - self._last_time)
+            if elapsed > 0:
+                average_rate = self._done / elapsed
+            self._last_done = self._done
+        self._last_time = now
+        self._callback(ProgressEvent(state, self._phase, self._done, self._phase_total, rate, average_rate, elapsed, message))
+
+    def start(self):
+        self._emit('start')
+
+    def finish(self):
+        """ Emits the end event. The bytes done are set to the total when it is known. """
+        if self._phase_total is not None:
+            self._done = self._phase_total
+        self._emit('end')
+
+    def feed(self, level, message):
+        """
+        Parses a DLL message. Signature of a LoggerAdapter listener.
+        """
+        chunk = self._CHUNK.search(message)
+        if chunk is not None:
+            offset, length, total = (int(value) for value in chunk.groups())
+            if self._phase != 'program':
+                self._start_phase('program')
+            self._done = offset + length
+            self._phase_total = total
+            self._emit('progress', message)
+            return
+
+        phase = phase_of(message)
+        if phase is not None and phase != self._phase:
+            self._start_phase(phase)
+
+        erase_range = self._ERASE_RANGE.search(message)
+        if erase_range is not None:
+            start, end = (int(value, 16) for value in erase_range.groups())
+            self._done = (self._done or 0) + end - start + 1
+            self._emit('progress', message)
+            return
+
+        count = self._COUNT.search(message)
+        if count is not None and self._phase_total is not None:
+            index, number = (int(value) for value in count.groups())
+            if number > 0:
+                self._done = self._phase_total * min(index, number) // number
+                self._emit('progress', message)
+
+
+@contextlib.contextmanager
+def track(logger, callback, phase, file_path=None, total=None):
+    """
+    Context manager following the progress of one operation on the LoggerAdapter of an API or probe.
+    Does nothing if callback is None. The end event is only emitted if the block succeeds.
+
+    @param Parameters.LoggerAdapter logger: Logger of the API or probe running the operation.
+    @param callable callback: Called with each ProgressEvent, or None.
+    @param str phase: Phase of the operation when it starts.
+    @param (optional) str file_path: Image file of the operation, to compute the total bytes.
+    @param (optional) int total: Total bytes of the operation, if known without file_path.
+    """
+    if callback is None:
+        yield None
+        return
+
+    if total is None and file_path is not None:
+        total = image_size(file_path)
+
+    if not logger.receives_dll_messages:
+        warnings.warn("The DLL messages are not received by this instance, progress is limited to the start and end events.",
+                      RuntimeWarning, stacklevel=4)
+
+    tracker = ProgressTracker(callback, phase, total)
+    logger.add_listener(tracker.feed, logging.INFO)
+    tracker.start()
+    try:
+        yield tracker
+    finally:
+        logger.remove_listener(tracker.feed)
+    tracker.finish()
+
+
+def iter_progress(function, *args, **kwargs):
+    """
+    Runs function(*args, progress=..., **kwargs) in a worker thread and yields its ProgressEvent objects.
+    Exceptions raised by the function are raised again by the iterator after the last event.
+
+    @param callable function: Function taking a progress parameter, i.e. probe.program.
+    """
+    events = queue.Queue()
+    done = object()
+    failure = list()
+
+    def worker():
+        try:
+            function(*args, progress=events.put, **kwargs)
+        except BaseException as error:
+            failure.append(error)
+        finally:
+            events.put(done)
+
+    thread = threading.Thread(target=worker, daemon=True)
+    thread.start()
+
+    while True:
+        event = events.get()
+        if event is done:
+            break
+        yield event
+
+    thread.join()
+    if failure:
+        raise failure[0]
@@ -0,0 +1,982 @@
+"""
+This module provides RTT streaming on top of the rtt functions of LowLevel.API and HighLevel.DebugProbe.
+
+An RTTStream runs one reader thread per instance. The thread polls all the up channels of the device, and reads each
+channel with rtt_read_into() directly into the free space of the ring buffer of the channel, so no memory is allocated
+per read. The application reads the rings through RTTChannel objects, with blocking calls, iterators or async iterators.
+
+When the ring of a channel is full, the reader stops reading that channel until the application catches up, leaving
+the data in the RTT buffer of the device. The firmware then blocks or drops data according to the mode of its channel.
+
+RTTWriter buffers the writes to a down channel. Small writes are coalesced up to the size of the channel buffer and sent
+when the buffer is full or after a short delay, and partial writes are retried until all the data is sent.
+
+RTTCapture writes up channels to rotating files for long captures. A file writer thread writes the rings of the stream
+to the files as they fill, straight from the memory of the rings, so the data is never decoded nor copied to Python
+objects, and the memory used stays constant however long the capture runs.
+
+locate_control_block() finds the RTT control block from the host, by reading the data RAM in large blocks and searching
+it, which is much faster than the search of the DLL on devices with large RAM. Found addresses can be kept in a
+ControlBlockCache by firmware image hash, so that later sessions on the same firmware attach after a single check.
+
+Example:
+    cache = RTT.ControlBlockCache('rtt_addresses.json')
+    RTT.locate_control_block(api, RTT.image_hash('image.hex'), cache)
+
+    with RTT.RTTStream(api) as stream, stream.writer(0) as writer:
+        writer.write('start\n')
+        for chunk in stream.channels[0]:
+            sys.stdout.buffer.write(chunk)
+
+    with RTT.RTTCapture(api, 'soak/{}_rtt{{channel}}_{{index:03d}}.log'.format(serial_number), timestamps=True):
+        run_soak_test()
+"""
+
+from __future__ import print_function
+
+import asyncio
+import collections
+import datetime
+import hashlib
+import json
+import os
+import struct
+import threading
+import time
+
+try:
+    from .APIError import *
+    from .Parameters import *
+except Exception:
+    from APIError import *
+    from Parameters import *
+
+
+class RingBuffer(object):
+    """
+    Byte ring buffer with one producer thread and one consumer thread.
+
+    The producer only advances the written count and the consumer only advances the read count. Both are plain integer
+    assignments, so neither side takes a lock to move data. Regions are memoryviews of the ring, to be filled or consumed
+    in place.
+    """
+
+    def __init__(self, capacity):
+        """
+        @param int capacity: Size of the ring in bytes.
+        """
+        if capacity <= 0:
+            raise ValueError('The capacity parameter must be a positive number of bytes.')
+
+        self.capacity = capacity
+        self._view = memoryview(bytearray(capacity))
+        # Total bytes written and read since creation.
+        self._written = 0
+        self._read = 0
+
+    def __len__(self):
+        return self._written - self._read
+
+    def free(self):
+        return self.capacity - (self._written - self._read)
+
+    def write_region(self):
+        """
+        Producer side.
+
+        @return memoryview: Contiguous free space at the write position, empty if the ring is full.
+        """
+        start = self._written % self.capacity
+        return self._view[start:start + min(self.free(), self.capacity - start)]
+
+    def commit(self, length):
+        """ Producer side. Publishes length bytes written into the write region. """
+        self._written += length
+
+    def read_region(self):
+        """
+        Consumer side.
+
+        @return memoryview: Contiguous data at the read position, empty if the ring is empty.
+        """
+        start = self._read % self.capacity
+        return self._view[start:start + min(len(self), self.capacity - start)]
+
+    def find(self, byte, start, end):
+        """
+        Consumer side. Searches the read region without copying it.
+
+        @return int: Index of byte in read_region()[start:end], -1 if not found.
+        """
+        offset = self._read % self.capacity
+        index = self._view.obj.find(byte, offset + start, offset + end)
+        return index - offset if index >= 0 else -1
+
+    def consume(self, length):
+        """ Consumer side. Releases length bytes of the read region. """
+        self._read += length
+
+
+class AdaptivePoller(object):
+    """
+    Schedules the polls of an rtt_read loop.
+
+    A read that fills its buffer means more data is waiting, so the next poll is immediate. An RTT buffer of size bytes
+    holds at most size - 1 bytes, so a read of size - 1 bytes emptied a full channel. After a read that returns some
+    data, the next poll is timed for the channel buffer to be about half full at the rate observed, so each read moves as
+    much data as possible without letting the buffer overflow. Polls that return nothing back off exponentially up to
+    max_interval, so idle probes cost almost no host CPU.
+
+    Example of a custom read loop, with reads sized to the channel:
+        _, size = api.rtt_read_channel_info(0, RTTChannelDirection.UP_DIRECTION)
+        buffer = bytearray(size)
+        poller = RTT.AdaptivePoller()
+        while running:
+            count = api.rtt_read_into(0, buffer)
+            handle(buffer[:count])
+            poller.wait(count, count >= size - 1, size)
+    """
+
+    def __init__(self, min_interval=0.0005, max_interval=0.05, backoff=2.0):
+        """
+        @param (optional) float min_interval: Seconds between polls while data arrives.
+        @param (optional) float max_interval: Longest delay in seconds between polls of idle channels, which bounds the latency when data starts arriving.
+        @param (optional) float backoff: Factor applied to the delay after each empty poll.
+        """
+        if not 0 <= min_interval <= max_interval:
+            raise ValueError('The intervals must satisfy 0 <= min_interval <= max_interval.')
+        if backoff < 1:
+            raise ValueError('The backoff parameter must be at least 1.')
+
+        self.min_interval = min_interval
+        self.max_interval = max_interval
+        self.backoff = backoff
+        self.interval = min_interval
+        self._last_poll = None
+
+    def next_delay(self, bytes_read, full, capacity=None):
+        """
+        @param int bytes_read: Number of bytes returned by the last poll.
+        @param bool full: True if a read of the last poll filled its buffer.
+        @param (optional) int capacity: Size in bytes of the smallest channel buffer polled. None polls after min_interval while data arrives.
+        @return float: Seconds to wait before the next poll.
+        """
+        now = time.monotonic()
+        since_last_poll = now - self._last_poll if self._last_poll is not None else None
+        self._last_poll = now
+
+        if full:
+            self.interval = self.min_interval
+            return 0.0
+
+        if bytes_read:
+            self.interval = self.min_interval
+            if capacity and since_last_poll:
+                rate = bytes_read / since_last_poll
+                self.interval = min(max(capacity / 2 / rate, self.min_interval), self.max_interval)
+        else:
+            self.interval = min(max(self.interval * self.backoff, self.min_interval), self.max_interval)
+        return self.interval
+
+    def wait(self, bytes_read, full, capacity=None, event=None):
+        """
+        Waits before the next poll.
+
+        @param int bytes_read: Number of bytes returned by the last poll.
+        @param bool full: True if a read of the last poll filled its buffer.
+        @param (optional) int capacity: Size in bytes of the smallest channel buffer polled.
+        @param (optional) threading.Event event: Event ending the wait early when set.
+        @return bool: True if the event was set.
+        """
+        delay = self.next_delay(bytes_read, full, capacity)
+        if event is not None:
+            return event.wait(delay) if delay else event.is_set()
+        if delay:
+            time.sleep(delay)
+        return False
+
+
+class RTTChannel(object):
+    """
+    Up channel of an RTTStream. Reading methods must be called from one thread or event loop at a time.
+    """
+
+    def __init__(self, stream, index, name, size, ring_size):
+        self._stream = stream
+        # RTT channel index, name and size of its buffer in the device.
+        self.index = index
+        self.name = name
+        self.size = size
+        self.ring = RingBuffer(ring_size)
+        self._data_event = threading.Event()
+        # Event loop futures of the async readers waiting for data.
+        self._waiters = list()
+        self._waiters_lock = threading.Lock()
+
+    def _notify(self):
+        """ Wakes the readers waiting for data. Called by the reader thread after writing, and when the stream ends. """
+        self._data_event.set()
+        with self._waiters_lock:
+            waiters, self._waiters = self._waiters, list()
+        for loop, future in waiters:
+            loop.call_soon_threadsafe(lambda future=future: future.done() or future.set_result(None))
+
+    def available(self):
+        """
+        @return int: Number of bytes that can be read without blocking.
+        """
+        return len(self.ring)
+
+    def _take(self, max_bytes):
+        region = self.ring.read_region()
+        if max_bytes is not None and max_bytes >= 0:
+            region = region[:max_bytes]
+        data = bytes(region)
+        self.ring.consume(len(data))
+        self._stream._space_event.set()
+        return data
+
+    def _wait(self, timeout):
+        """ Waits for data, returns False if the stream ended or the timeout elapsed first. """
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while not len(self.ring):
+            self._stream._raise_error()
+            if self._stream.closed:
+                return False
+            self._data_event.clear()
+            # Check again, the reader may have written before the event was cleared.
+            if len(self.ring):
+                break
+            remaining = None if deadline is None else deadline - time.monotonic()
+            if remaining is not None and remaining <= 0:
+                return False
+            self._data_event.wait(remaining)
+        return True
+
+    def read(self, max_bytes=-1, timeout=None):
+        """
+        Reads the data received on the channel. Blocks until data is available.
+
+        @param (optional) int max_bytes: Maximum number of bytes to return, negative for all the contiguous data available.
+        @param (optional) float timeout: Seconds to wait for data. None waits until data arrives or the stream ends.
+        @return bytes: Data read, empty if the stream ended or the timeout elapsed.
+        @raise APIError: The reader thread failed.
+        """
+        if not self._wait(timeout):
+            return b''
+        return self._take(max_bytes)
+
+    def readinto(self, buffer, timeout=None):
+        """
+        Reads the data received on the channel into a buffer. Blocks until data is available.
+
+        @param buffer buffer: Writable buffer to fill.
+        @param (optional) float timeout: Seconds to wait for data. None waits until data arrives or the stream ends.
+        @return int: Number of bytes read, 0 if the stream ended or the timeout elapsed.
+        """
+        view = memoryview(buffer).cast('B')
+        if not self._wait(timeout):
+            return 0
+
+        count = 0
+        while count < len(view) and len(self.ring):
+            region = self.ring.read_region()[:len(view) - count]
+            view[count:count + len(region)] = region
+            self.ring.consume(len(region))
+            count += len(region)
+        self._stream._space_event.set()
+        return count
+
+    def __iter__(self):
+        """ Yields the data received as bytes chunks until the stream ends. """
+        while True:
+            data = self.read()
+            if not data:
+                return
+            yield data
+
+    def __aiter__(self):
+        return self
+
+    async def __anext__(self):
+        data = await self.read_async()
+        if not data:
+            raise StopAsyncIteration
+        return data
+
+    async def read_async(self, max_bytes=-1):
+        """
+        Coroutine version of read(), waiting for data without blocking the event loop.
+
+        @return bytes: Data read, empty if the stream ended.
+        """
+        loop = asyncio.get_running_loop()
+        while not len(self.ring):
+            self._stream._raise_error()
+            if self._stream.closed:
+                return b''
+            future = loop.create_future()
+            with self._waiters_lock:
+                self._waiters.append((loop, future))
+            # Check again, the reader may have written before the future was registered.
+            if not len(self.ring) and not self._stream.closed:
+                await future
+        return self._take(max_bytes)
+
+
+class RTTStream(object):
+    """
+    Background reader of the RTT up channels of a LowLevel.API or HighLevel.DebugProbe.
+
+    The instance must not be used by other threads while the stream runs, except through the lock of the stream.
+    """
+
+    def __init__(self, api, channels=None, ring_size=65536, poller=None, start_timeout=5.0):
+        """
+        Constructor. Starts RTT if needed, and starts the reader thread.
+
+        @param LowLevel.API or HighLevel.DebugProbe api: Instance connected to the device.
+        @param (optional) [int] channels: Indexes of the up channels to read. None reads all the up channels of the device.
+        @param (optional) int ring_size: Size in bytes of the ring buffer of each channel.
+        @param (optional) AdaptivePoller poller: Schedule of the polls. Defaults to an AdaptivePoller with default parameters, use AdaptivePoller(interval, interval) for a fixed interval.
+        @param (optional) float start_timeout: Seconds to wait for the RTT control block to be found.
+        """
+        self._api = api
+        self.poller = poller if poller is not None else AdaptivePoller()
+        # Held by the reader thread around each DLL call.
+        self.lock = threading.RLock()
+        self.closed = False
+        self._error = None
+        self._stop = threading.Event()
+        self._space_event = threading.Event()
+        # Set when any channel received data, and when the stream ends.
+        self._data_event = threading.Event()
+
+        with self.lock:
+            self._start_rtt(start_timeout)
+            _, up_channels = api.rtt_read_channel_count()
+            if channels is None:
+                channels = range(up_channels)
+
+            self.channels = dict()
+            for index in channels:
+                if not 0 <= index < up_channels:
+                    raise ValueError('The device has no RTT up channel {}.'.format(index))
+                name, size = api.rtt_read_channel_info(index, RTTChannelDirection.UP_DIRECTION)
+                self.channels[index] = RTTChannel(self, index, name, size, ring_size)
+
+        self._capacity = min([channel.size for channel in self.channels.values()], default=None)
+
+        self._thread = threading.Thread(target=self._run, name='RTTStream reader', daemon=True)
+        self._thread.start()
+
+    def _start_rtt(self, timeout):
+        deadline = time.monotonic() + timeout
+        if not self._api.is_rtt_started():
+            self._api.rtt_start()
+        while not self._api.rtt_is_control_block_found():
+            if time.monotonic() > deadline:
+                raise APIError(NrfjprogdllErr.TIME_OUT, 'The RTT control block was not found.')
+            time.sleep(0.01)
+
+    def _raise_error(self):
+        if self._error is not None:
+            raise self._error
+
+    def _poll(self):
+        """
+        Reads each channel once into its ring, at most the size of the channel buffer.
+
+        @return (int, bool): Number of bytes read, and True if a read filled its region.
+        """
+        total = 0
+        full = False
+        for channel in self.channels.values():
+            region = channel.ring.write_region()[:channel.size]
+            if not region:
+                continue
+            with self.lock:
+                count = self._api.rtt_read_into(channel.index, region)
+            if count:
+                channel.ring.commit(count)
+                channel._notify()
+                total += count
+                # The RTT buffer of the device holds at most size - 1 bytes.
+                full = full or count == len(region) or count >= channel.size - 1
+        if total:
+            self._data_event.set()
+        return total, full
+
+    def _run(self):
+        try:
+            while not self._stop.is_set():
+                total, full = self._poll()
+                if not total and all(not channel.ring.free() for channel in self.channels.values()):
+                    # All rings are full, wait for the application to read.
+                    self._space_event.clear()
+                    self._space_event.wait(self.poller.max_interval)
+                else:
+                    self.poller.wait(total, full, self._capacity, self._stop)
+            # Take the data received since the last poll.
+            self._poll()
+        except Exception as error:
+            # Raised again to the readers of the channels.
+            self._error = error
+        finally:
+            self.closed = True
+            self._data_event.set()
+            for channel in self.channels.values():
+                channel._notify()
+
+    def writer(self, channel_index, **kwargs):
+        """
+        Creates an RTTWriter sharing the lock of the stream, so that its writes do not run concurrently with the reads.
+
+        @param int channel_index: Index of the down channel.
+        Other keyword arguments are passed to RTTWriter.
+        @return RTTWriter: Writer of the channel.
+        """
+        return RTTWriter(self._api, channel_index, lock=self.lock, **kwargs)
+
+    def close(self):
+        """
+        Stops the reader thread after a last poll. Data already in the rings can still be read. RTT is left started.
+        """
+        self._stop.set()
+        if self._thread is not threading.current_thread():
+            self._thread.join()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, ex_type, ex_value, traceback):
+        self.close()
+
+
+class RTTWriter(object):
+    """
+    Buffered writer of an RTT down channel. Thread-safe.
+
+    Data is sent when the pending data fills the channel buffer, flush_delay seconds after the first pending write, or
+    when flush() or close() is called. Writes the device does not accept in full are retried as long as the device keeps
+    accepting data, and fail after write_timeout seconds without progress. A flusher thread per writer sends the data
+    whose delay elapsed, its errors are raised by the next call.
+    """
+
+    def __init__(self, api, channel_index=0, flush_delay=0.002, write_timeout=1.0, encoding='utf-8', lock=None):
+        """
+        @param LowLevel.API or HighLevel.DebugProbe api: Instance connected to the device, with RTT started.
+        @param (optional) int channel_index: Index of the down channel.
+        @param (optional) float flush_delay: Longest time in seconds data waits in the buffer.
+        @param (optional) float write_timeout: Seconds to wait for the device to accept more data when its buffer is full.
+        @param (optional) str encoding: Encoding of the str data written.
+        @param (optional) threading.RLock lock: Lock held around the DLL calls, i.e. the lock of an RTTStream on the same instance.
+        """
+        self._api = api
+        self.channel_index = channel_index
+        self.flush_delay = flush_delay
+        self.write_timeout = write_timeout
+        self.encoding = encoding
+        self._api_lock = lock if lock is not None else threading.RLock()
+
+        with self._api_lock:
+            self.name, self.size = api.rtt_read_channel_info(channel_index, RTTChannelDirection.DOWN_DIRECTION)
+        # The RTT buffer of the device holds at most size - 1 bytes, the most one write can send.
+        self._chunk_size = max(self.size - 1, 1)
+
+        self._pending = bytearray()
+        # Time at which the pending data must be sent, None when nothing is pending.
+        self._deadline = None
+        # Protects the pending data and the deadline, and wakes the flusher thread.
+        self._condition = threading.Condition()
+        # Serializes the flushes, so that data is sent in order.
+        self._flush_lock = threading.Lock()
+        self._error = None
+        # Total number of bytes accepted by the device.
+        self.bytes_sent = 0
+        self.closed = False
+
+        self._thread = threading.Thread(target=self._run, name='RTTWriter flusher', daemon=True)
+        self._thread.start()
+
+    def _raise_error(self):
+        error, self._error = self._error, None
+        if error is not None:
+            raise error
+
+    def write(self, data):
+        """
+        Queues data to send.
+
+        @param str, bytes or buffer data: Data to write. str data is encoded with the encoding of the writer.
+        @return int: Number of bytes queued.
+        """
+        if self.closed:
+            raise ValueError('The writer is closed.')
+        self._raise_error()
+
+        if isinstance(data, str):
+            data = data.encode(self.encoding)
+
+        with self._condition:
+            self._pending += data
+            full = len(self._pending) >= self._chunk_size
+            # Also set when full, for the data left after the whole chunks are sent.
+            if self._deadline is None:
+                self._deadline = time.monotonic() + self.flush_delay
+                self._condition.notify()
+
+        if full:
+            self._flush(whole_chunks=True)
+        return len(data)
+
+    def _run(self):
+        while True:
+            with self._condition:
+                while not self.closed and (self._deadline is None or self._deadline > time.monotonic()):
+                    self._condition.wait(None if self._deadline is None else self._deadline - time.monotonic())
+                if self.closed:
+                    return
+            try:
+                self._flush()
+            except Exception as error:
+                self._error = error
+
+    def _flush(self, whole_chunks=False):
+        with self._flush_lock:
+            with self._condition:
+                length = len(self._pending)
+                if whole_chunks:
+                    length -= length % self._chunk_size
+                data = bytes(self._pending[:length])
+                del self._pending[:length]
+                if not self._pending:
+                    self._deadline = None
+            if data:
+                self._send(data)
+
+    def _send(self, data):
+        view = memoryview(data)
+        deadline = time.monotonic() + self.write_timeout
+        delay = 0.0005
+        while view:
+            with self._api_lock:
+                count = self._api.rtt_write(self.channel_index, view[:self._chunk_size], None)
+            view = view[count:]
+            if count:
+                self.bytes_sent += count
+                deadline = time.monotonic() + self.write_timeout
+                delay = 0.0005
+                continue
+
+            # The channel buffer of the device is full, wait for the firmware to read it.
+            if time.monotonic() > deadline:
+                raise APIError(NrfjprogdllErr.TIME_OUT, 'RTT channel {} accepted no data for {} s, {} of {} bytes were sent.'.format(
+                    self.channel_index, self.write_timeout, len(data) - len(view), len(data)))
+            time.sleep(delay)
+            delay = min(delay * 2, 0.01)
+
+    def flush(self):
+        """
+        Sends all the pending data.
+
+        @raise APIError: The device accepted no data for write_timeout seconds, or a DLL call failed.
+        """
+        self._raise_error()
+        self._flush()
+
+    def close(self):
+        """
+        Stops the flusher thread and sends the pending data.
+        """
+        if self.closed:
+            return
+        with self._condition:
+            self.closed = True
+            self._condition.notify()
+        if self._thread is not threading.current_thread():
+            self._thread.join()
+        self.flush()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, ex_type, ex_value, traceback):
+        self.close()
+
+
+class _CaptureFile(object):
+    """ Files of one channel of an RTTCapture. """
+
+    def __init__(self, channel):
+        self.channel = channel
+        self.index = -1
+        self.file = None
+        self.size = 0
+        self.paths = collections.deque()
+        self.bytes_written = 0
+        self.line_start = True
+
+
+class RTTCapture(object):
+    """
+    Captures RTT up channels to rotating files.
+
+    One file is written per channel. A new file is started when the current one reaches max_file_size, and with
+    max_files the oldest files of the channel are deleted, so the disk space used is bounded too. Files are flushed
+    every flush_interval seconds, so that little data is lost if the host crashes.
+
+    The ring of each channel absorbs the data received while the disk stalls. When a ring is full the stream stops
+    reading the channel, and the firmware blocks or drops data according to the mode of its channel.
+    """
+
+    def __init__(self, api, file_path_format, channels=None, max_file_size=64 * 1024 * 1024, max_files=None,
+                 timestamps=False, ring_size=1024 * 1024, poller=None, flush_interval=1.0, start_timeout=5.0):
+        """
+        Constructor. Starts the stream and the file writer thread.
+
+        @param LowLevel.API or HighLevel.DebugProbe api: Instance connected to the device.
+        @param str file_path_format: Path of the files, formatted with the channel and index keywords, i.e. 'rtt{channel}_{index:03d}.log'. Existing files are overwritten.
+        @param (optional) [int] channels: Indexes of the up channels to capture. None captures all the up channels of the device.
+        @param (optional) int max_file_size: Size in bytes at which a new file is started.
+        @param (optional) int max_files: Number of files kept per channel. None keeps all the files.
+        @param (optional) bool timestamps: Prefix each line with the host time at which it was written.
+        @param (optional) int ring_size: Size in bytes of the ring buffer of each channel.
+        @param (optional) AdaptivePoller poller: Schedule of the polls, see RTTStream.
+        @param (optional) float flush_interval: Longest time in seconds data stays in the file buffers.
+        @param (optional) float start_timeout: Seconds to wait for the RTT control block to be found.
+        """
+        if max_file_size <= 0:
+            raise ValueError('The max_file_size parameter must be a positive number of bytes.')
+        if max_files is not None and max_files < 1:
+            raise ValueError('The max_files parameter must be at least 1.')
+
+        self.file_path_format = file_path_format
+        self.max_file_size = max_file_size
+        self.max_files = max_files
+        self.timestamps = timestamps
+        self.flush_interval = flush_interval
+        self._error = None
+
+        self.stream = RTTStream(api, channels, ring_size, poller, start_timeout)
+        self._files = [_CaptureFile(channel) for channel in self.stream.channels.values()]
+        try:
+            for capture_file in self._files:
+                self._rotate(capture_file)
+        except Exception:
+            self.stream.close()
+            self._close_files()
+            raise
+
+        self._thread = threading.Thread(target=self._run, name='RTTCapture writer', daemon=True)
+        self._thread.start()
+
+    def _rotate(self, capture_file):
+        if capture_file.file is not None:
+            capture_file.file.close()
+
+        capture_file.index += 1
+        path = self.file_path_format.format(channel=capture_file.channel.index, index=capture_file.index)
+        capture_file.file = open(path, 'wb')
+        capture_file.size = 0
+        capture_file.paths.append(path)
+
+        if self.max_files is not None:
+            while len(capture_file.paths) > self.max_files:
+                os.remove(capture_file.paths.popleft())
+
+    def _write(self, capture_file, view):
+        while view:
+            room = self.max_file_size - capture_file.size
+            if room <= 0:
+                self._rotate(capture_file)
+                continue
+            part = view[:room]
+            capture_file.file.write(part)
+            capture_file.size += len(part)
+            capture_file.bytes_written += len(part)
+            view = view[len(part):]
+
+    def _write_lines(self, capture_file, region, timestamp):
+        """ Writes region with timestamp before each line. """
+        ring = capture_file.channel.ring
+        start = 0
+        while start < len(region):
+            if capture_file.line_start:
+                self._write(capture_file, timestamp)
+                capture_file.line_start = False
+            end = ring.find(b'\n', start, len(region))
+            if end < 0:
+                end = len(region)
+            else:
+                end += 1
+                capture_file.line_start = True
+            self._write(capture_file, region[start:end])
+            start = end
+
+    def _drain(self):
+        """
+        Writes the contiguous data of each ring to its file.
+
+        @return int: Number of bytes taken from the rings.
+        """
+        total = 0
+        timestamp = None
+        for capture_file in self._files:
+            ring = capture_file.channel.ring
+            region = ring.read_region()
+            if not region:
+                continue
+            if self.timestamps:
+                if timestamp is None:
+                    # One timestamp per drain, the lines of a drain were received within a few polls.
+                    timestamp = '[{}] '.format(datetime.datetime.now().isoformat(' ', 'microseconds')).encode()
+                self._write_lines(capture_file, region, timestamp)
+            else:
+                self._write(capture_file, region)
+            ring.consume(len(region))
+            total += len(region)
+
+        if total:
+            self.stream._space_event.set()
+        return total
+
+    def _flush_files(self):
+        for capture_file in self._files:
+            capture_file.file.flush()
+
+    def _run(self):
+        data_event = self.stream._data_event
+        next_flush = time.monotonic() + self.flush_interval
+        try:
+            while True:
+                # Read before draining, all the data of a closed stream is already in the rings.
+                closed = self.stream.closed
+                data_event.clear()
+                total = self._drain()
+
+                if time.monotonic() >= next_flush:
+                    self._flush_files()
+                    next_flush = time.monotonic() + self.flush_interval
+
+                if not total:
+                    if closed:
+                        break
+                    data_event.wait(max(next_flush - time.monotonic(), 0))
+        except Exception as error:
+            # Raised by close(). Stops the stream, which would otherwise fill the rings and stop reading.
+            self._error = error
+            self.stream._stop.set()
+
+    def _close_files(self):
+        for capture_file in self._files:
+            if capture_file.file is not None:
+                capture_file.file.close()
+
+    @property
+    def files(self):
+        """
+        @return dict: Paths of the files kept, oldest first, by channel index.
+        """
+        return dict((capture_file.channel.index, list(capture_file.paths)) for capture_file in self._files)
+
+    @property
+    def bytes_written(self):
+        """
+        @return dict: Number of bytes written to the files, timestamps included, by channel index.
+        """
+        return dict((capture_file.channel.index, capture_file.bytes_written) for capture_file in self._files)
+
+    def close(self):
+        """
+        Stops the capture, writes the data left in the rings, and closes the files.
+
+        @raise APIError: The reader thread failed.
+        @raise OSError: Writing a file failed.
+        """
+        self.stream.close()
+        self._thread.join()
+        self._close_files()
+
+        if self._error is not None:
+            raise self._error
+        self.stream._raise_error()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, ex_type, ex_value, traceback):
+        self.close()
+
+
+# The control block starts with this id, followed by the number of up and down buffers as 32-bit integers.
+CONTROL_BLOCK_ID = b'SEGGER RTT\x00'
+_CONTROL_BLOCK_HEADER = struct.Struct('<16sii')
+# Upper bound of the buffer counts, to reject stray copies of the id.
+_MAX_BUFFERS = 64
+
+
+def image_hash(file_path):
+    """
+    @param str file_path: Path to the firmware image file.
+    @return str: SHA-256 of the image file, to use as the ControlBlockCache key of the firmware.
+    """
+    digest = hashlib.sha256()
+    with open(file_path, 'rb') as image:
+        for block in iter(lambda: image.read(1 << 20), b''):
+            digest.update(block)
+    return digest.hexdigest()
+
+
+class ControlBlockCache(object):
+    """
+    JSON file of RTT control block addresses by firmware image hash. Thread-safe within a process.
+    """
+
+    def __init__(self, file_path, max_entries=256):
+        """
+        @param str file_path: Path of the cache file. It is created when the first address is stored.
+        @param (optional) int max_entries: Number of firmware images kept, the least recently stored are dropped first.
+        """
+        self.file_path = file_path
+        self.max_entries = max_entries
+        self._lock = threading.Lock()
+
+    def _load(self):
+        try:
+            with open(self.file_path, 'r') as cache_file:
+                entries = json.load(cache_file)
+        except (OSError, ValueError):
+            return dict()
+        return entries if isinstance(entries, dict) else dict()
+
+    def get(self, firmware_hash):
+        """
+        @param str firmware_hash: Hash of the firmware image, see image_hash().
+        @return int: Cached control block address, None if the firmware is not cached.
+        """
+        with self._lock:
+            address = self._load().get(firmware_hash)
+        return address if isinstance(address, int) else None
+
+    def put(self, firmware_hash, address):
+        """
+        Stores the control block address of a firmware image.
+        """
+        with self._lock:
+            entries = self._load()
+            entries.pop(firmware_hash, None)
+            entries[firmware_hash] = address
+            # Dicts keep the insertion order, so the least recently stored entries are first.
+            for key in list(entries)[:max(0, len(entries) - self.max_entries)]:
+                del entries[key]
+
+            temporary_path = '{}.tmp'.format(self.file_path)
+            with open(temporary_path, 'w') as cache_file:
+                json.dump(entries, cache_file)
+            os.replace(temporary_path, self.file_path)
+
+
+def data_ram_ranges(api):
+    """
+    Returns the data RAM ranges of the device, from read_memory_descriptors() on a LowLevel.API and from get_device_info() on a HighLevel.DebugProbe.
+
+    @param LowLevel.API or HighLevel.DebugProbe api: Instance connected to the device.
+    @return [(int, int)]: (start address, size) of each data RAM.
+    """
+    if hasattr(api, 'read_memory_descriptors'):
+        return [(memory.start, memory.size) for memory in api.read_memory_descriptors(False) if memory.type == MemoryType.DATA_RAM]
+
+    device_info = api.get_device_info()
+    return [(device_info.data_ram_address, device_info.ram_size)]
+
+
+def _is_control_block(data, position=0):
+    identifier, up_buffers, down_buffers = _CONTROL_BLOCK_HEADER.unpack_from(data, position)
+    return identifier.startswith(CONTROL_BLOCK_ID) and 0 < up_buffers <= _MAX_BUFFERS and 0 <= down_buffers <= _MAX_BUFFERS
+
+
+def is_control_block_at(api, address):
+    """
+    @param LowLevel.API or HighLevel.DebugProbe api: Instance connected to the device.
+    @param int address: Address to check.
+    @return bool: True if an RTT control block starts at address.
+    """
+    header = bytearray(_CONTROL_BLOCK_HEADER.size)
+    try:
+        api.read_into(address, header)
+    except APIError:
+        return False
+    return _is_control_block(header)
+
+
+def find_control_block(api, ranges=None, block_size=0x10000):
+    """
+    Searches the RTT control block in device memory. Memory is read in blocks of block_size bytes into one buffer, which
+    is searched in place with bytearray.find. The last bytes of a block are kept in front of the next one, so that a
+    control block across two blocks is found. Blocks that can not be read, i.e. unpowered RAM, are skipped.
+
+    @param LowLevel.API or HighLevel.DebugProbe api: Instance connected to the device.
+    @param (optional) [(int, int)] ranges: (start address, size) of the memory to search. Defaults to data_ram_ranges(api).
+    @param (optional) int block_size: Number of bytes read at a time.
+    @return int: Address of the control block, None if it was not found.
+    """
+    if ranges is None:
+        ranges = data_ram_ranges(api)
+
+    header_size = _CONTROL_BLOCK_HEADER.size
+    overlap = header_size - 1
+    buffer = bytearray(overlap + block_size)
+    view = memoryview(buffer)
+
+    for start, size in ranges:
+        # Number of bytes at the start of buffer kept from the end of the previous block.
+        kept = 0
+        offset = 0
+        while offset < size:
+            length = min(block_size, size - offset)
+            try:
+                api.read_into(start + offset, view[kept:kept + length])
+            except APIError:
+                kept = 0
+                offset += length
+                continue
+
+            end = kept + length
+            position = buffer.find(CONTROL_BLOCK_ID, 0, end)
+            while position != -1:
+                if position + header_size <= end and _is_control_block(buffer, position):
+                    return start + offset - kept + position
+                position = buffer.find(CONTROL_BLOCK_ID, position + 1, end)
+
+            kept = min(overlap, end)
+            buffer[:kept] = view[end - kept:end]
+            offset += length
+    return None
+
+
+def locate_control_block(api, firmware_hash=None, cache=None, start=True):
+    """
+    Finds the RTT control block and gives its address to the DLL with rtt_set_control_block_address(), so that RTT
+    starts without the search of the DLL. A cached address is used if the control block is still there.
+
+    @param LowLevel.API or HighLevel.DebugProbe api: Instance connected to the device.
+    @param (optional) str firmware_hash: Hash of the firmware running on the device, see image_hash(). Required to use the cache.
+    @param (optional) ControlBlockCache cache: Cache of the addresses by firmware hash.
+    @param (optional) bool start: Calls rtt_start() after setting the address.
+    @return int: Address of the control block, None if it was not found. RTT is not started in that case.
+    """
+    use_cache = cache is not None and firmware_hash is not None
+
+    address = cache.get(firmware_hash) if use_cache else None
+    if address is None or not is_control_block_at(api, address):
+        address = find_control_block(api)
+        if address is None:
+            return None
+        if use_cache:
+            cache.put(firmware_hash, address)
+
+    api.rtt_set_control_block_address(address)
+    if start:
+        api.rtt_start()
+    return address
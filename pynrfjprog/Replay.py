@@ -0,0 +1,512 @@
+"""
+This module records the DLL calls of LowLevel and HighLevel instances to a compact binary file, and replays them.
+
+CallRecorder is a call observer, see Instrumentation.py. It writes each NRFJPROG_* call with its arguments after the call,
+its return code and its timing, and the info and error messages logged by the DLL during the call. Small buffers are
+stored whole, larger ones as their size and a digest. The file is a zlib stream of struct-packed records.
+
+ReplayLibrary is a stub library built from a recording. It returns the recorded return codes, fills the output arguments
+with the recorded values, logs the recorded messages and waits for the recorded durations. LowLevelAPI and HighLevelAPI
+run the Python layer on it, to reproduce production sessions offline and benchmark changes to the wrappers with real call
+mixes. Calls are matched to the recording by handle and function name, and a ReplayError is raised when they diverge.
+
+The recorder must be added before the API is opened, so that the replay can open it too.
+
+Example:
+    recorder = Replay.CallRecorder('station.rec')
+    api = LowLevel.API('NRF52')
+    api.add_call_observer(recorder)
+    api.open()
+    ...
+    recorder.close()
+
+    library = Replay.ReplayLibrary('station.rec')
+    with Replay.LowLevelAPI('NRF52', library) as api:
+        run_station_script(api)
+"""
+
+from __future__ import print_function
+
+import collections
+import ctypes
+import hashlib
+import logging
+import struct
+import threading
+import time
+import weakref
+import zlib
+
+try:
+    from . import HighLevel
+    from . import LowLevel
+    from .APIError import *
+    from .Parameters import *
+except Exception:
+    import HighLevel
+    import LowLevel
+    from APIError import *
+    from Parameters import *
+
+
+_MAGIC = b'NRFJREC2'
+
+# Record types.
+_NAME = 1
+_OWNER = 2
+_CALL = 3
+_MESSAGE = 4
+
+# Argument tags.
+_ARG_NONE = 0
+_ARG_INT = 1
+_ARG_BYTES = 2
+_ARG_SCALAR = 3
+_ARG_SCALAR_NONE = 4
+_ARG_SCALAR_FLOAT = 5
+_ARG_SCALAR_BYTES = 6
+_ARG_BUFFER = 7
+_ARG_CALLBACK = 8
+
+_U8 = struct.Struct('<B')
+_U16 = struct.Struct('<H')
+_U32 = struct.Struct('<I')
+_I64 = struct.Struct('<q')
+_F64 = struct.Struct('<d')
+_CALL_HEADER = struct.Struct('<BIHddiB')
+_MESSAGE_HEADER = struct.Struct('<BIB')
+_BUFFER_HEADER = struct.Struct('<BI8sI')
+
+_DIGEST_SIZE = 8
+
+# nrfjprogdll_log_level of each logging level, to log the recorded messages through the DLL log callback.
+_DLL_LOG_LEVELS = {
+    logging.CRITICAL: NrfjrpogdllLogLevel.critical,
+    logging.ERROR: NrfjrpogdllLogLevel.error,
+    logging.WARNING: NrfjrpogdllLogLevel.warning,
+    logging.INFO: NrfjrpogdllLogLevel.info,
+    logging.DEBUG: NrfjrpogdllLogLevel.debug,
+}
+
+
+class ReplayError(Exception):
+    """ Raised by ReplayLibrary when the calls made diverge from the recording. """
+
+
+RecordedArg = collections.namedtuple('RecordedArg', ['kind', 'value', 'size', 'digest'])
+RecordedArg.__doc__ = """
+Argument of a recorded call, after the call. kind is 'none', 'int', 'bytes', 'scalar', 'buffer' or 'callback'.
+value is the value of int, bytes and scalar arguments, and the content of buffers if it was stored, None otherwise.
+size and digest are set for buffers.
+"""
+
+RecordedCall = collections.namedtuple('RecordedCall', ['owner', 'name', 'start', 'duration', 'result', 'args', 'messages'])
+RecordedCall.__doc__ = """
+Recorded DLL call. owner is the id of the API or probe, start the seconds since the start of the recording, and messages
+a list of (logging level, message) logged by the DLL during the call.
+"""
+
+
+def _to_i64(value):
+    value = int(value)
+    return value - (1 << 64) if value >= (1 << 63) else value
+
+
+def _digest(data):
+    return hashlib.blake2b(data, digest_size=_DIGEST_SIZE).digest()
+
+
+class CallRecorder(object):
+    """
+    Call observer writing the DLL calls to a binary file. Thread-safe.
+    The recorded APIs and probes are not kept alive by the recorder. Each one gets a new owner id, never reused.
+    A call that can not be encoded is not recorded, and counted in dropped_calls, so that the DLL call itself succeeds.
+    """
+
+    def __init__(self, file_path, max_buffer_size=1024, compression_level=6):
+        """
+        @param str file_path: Path of the recording to write.
+        @param (optional) int max_buffer_size: Buffers up to this size in bytes are stored whole, larger ones as a digest.
+        @param (optional) int compression_level: zlib compression level, 0 to 9.
+        """
+        self._file = open(file_path, 'wb')
+        self._file.write(_MAGIC)
+        self._compressor = zlib.compressobj(compression_level)
+        self._max_buffer_size = max_buffer_size
+
+        self._names = dict()
+        # Owner ids of the live owners by Python id. Entries are removed by the finalizers of the owners.
+        self._owners = dict()
+        self._owner_count = 0
+        # Owners that can not be referenced weakly, kept alive so that their Python id is not reused.
+        self._strong_owners = list()
+        # Number of calls that could not be recorded.
+        self.dropped_calls = 0
+        # Messages logged by the DLL during the call in progress, by owner id.
+        self._messages = dict()
+        self._listeners = dict()
+        self._origin = time.perf_counter()
+        self._lock = threading.Lock()
+
+    def _write(self, data):
+        self._file.write(self._compressor.compress(data))
+
+    def _name_id(self, name):
+        name_id = self._names.get(name)
+        if name_id is None:
+            name_id = self._names[name] = len(self._names)
+            encoded = name.encode('utf-8')
+            self._write(_U8.pack(_NAME) + _U16.pack(name_id) + _U16.pack(len(encoded)) + encoded)
+        return name_id
+
+    def _owner_id(self, owner):
+        key = id(owner)
+        owner_id = self._owners.get(key)
+        if owner_id is None:
+            owner_id = self._owners[key] = self._owner_count
+            self._owner_count += 1
+            try:
+                weakref.finalize(owner, self._forget_owner, key, owner_id)
+            except TypeError:
+                self._strong_owners.append(owner)
+            encoded = type(owner).__name__.encode('utf-8')
+            self._write(_U8.pack(_OWNER) + _U32.pack(owner_id) + _U16.pack(len(encoded)) + encoded)
+        return owner_id
+
+    def _forget_owner(self, key, owner_id):
+        # Called when an owner is deleted, possibly while the lock is held, so only use atomic dict operations.
+        self._owners.pop(key, None)
+        self._listeners.pop(owner_id, None)
+        self._messages.pop(owner_id, None)
+
+    def on_attach(self, owner):
+        with self._lock:
+            owner_id = self._owner_id(owner)
+
+        logger = getattr(owner, '_logger', None)
+        if logger is not None and owner_id not in self._listeners:
+            listener = lambda level, message: self._on_message(owner_id, level, message)
+            self._listeners[owner_id] = listener
+            logger.add_listener(listener, logging.INFO)
+
+    def on_detach(self, owner):
+        with self._lock:
+            owner_id = self._owner_id(owner)
+        listener = self._listeners.pop(owner_id, None)
+        if listener is not None:
+            owner._logger.remove_listener(listener)
+
+    def _on_message(self, owner_id, level, message):
+        with self._lock:
+            self._messages.setdefault(owner_id, list()).append((level, message))
+
+    def _encode_arg(self, arg):
+        arg = getattr(arg, '_obj', arg)
+
+        if arg is None:
+            return _U8.pack(_ARG_NONE)
+        if isinstance(arg, (bool, int)):
+            return _U8.pack(_ARG_INT) + _I64.pack(_to_i64(arg))
+        if isinstance(arg, (bytes, str)):
+            data = arg.encode('utf-8') if isinstance(arg, str) else arg
+            return _U8.pack(_ARG_BYTES) + _U32.pack(len(data)) + data
+        if isinstance(arg, ctypes._CFuncPtr):
+            return _U8.pack(_ARG_CALLBACK)
+        if isinstance(arg, ctypes._SimpleCData):
+            value = arg.value
+            if value is None:
+                return _U8.pack(_ARG_SCALAR_NONE)
+            if isinstance(value, float):
+                return _U8.pack(_ARG_SCALAR_FLOAT) + _F64.pack(value)
+            if isinstance(value, bytes):
+                return _U8.pack(_ARG_SCALAR_BYTES) + _U32.pack(len(value)) + value
+            return _U8.pack(_ARG_SCALAR) + _I64.pack(_to_i64(value))
+        if isinstance(arg, (ctypes.Array, ctypes.Structure, ctypes.Union)):
+            data = ctypes.string_at(ctypes.addressof(arg), ctypes.sizeof(arg))
+            stored = data if len(data) <= self._max_buffer_size else b''
+            return _BUFFER_HEADER.pack(_ARG_BUFFER, len(data), _digest(data), len(stored)) + stored
+        return _U8.pack(_ARG_NONE)
+
+    def on_call(self, owner, name, args, result, start, end):
+        # Only DLL functions can be replayed.
+        if not name.startswith('NRFJPROG_'):
+            return
+
+        try:
+            encoded_args = b''.join(self._encode_arg(arg) for arg in args)
+        except Exception:
+            self.dropped_calls += 1
+            return
+
+        with self._lock:
+            if self._file is None:
+                return
+
+            owner_id = self._owner_id(owner)
+            messages = self._messages.pop(owner_id, ())
+            try:
+                # Encode the whole record before writing it, so that a failure does not leave a partial record.
+                records = list()
+                for level, message in messages:
+                    encoded = message.encode('utf-8')[:0xFFFF]
+                    records.append(_MESSAGE_HEADER.pack(_MESSAGE, owner_id, level) + _U16.pack(len(encoded)) + encoded)
+                records.append(_CALL_HEADER.pack(_CALL, owner_id, self._name_id(name), start - self._origin, end - start,
+                                                 int(result or 0), len(args)) + encoded_args)
+            except Exception:
+                self.dropped_calls += 1
+                return
+            self._write(b''.join(records))
+
+    def close(self):
+        """
+        Finishes the recording file. Later calls are not recorded.
+        """
+        with self._lock:
+            if self._file is None:
+                return
+            self._file.write(self._compressor.flush())
+            self._file.close()
+            self._file = None
+            self._owners.clear()
+            self._strong_owners = list()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, ex_type, ex_value, traceback):
+        self.close()
+
+
+class _Reader(object):
+    def __init__(self, data):
+        self._data = data
+        self._offset = 0
+
+    def at_end(self):
+        return self._offset >= len(self._data)
+
+    def unpack(self, structure):
+        values = structure.unpack_from(self._data, self._offset)
+        self._offset += structure.size
+        return values
+
+    def read(self, length):
+        data = self._data[self._offset:self._offset + length]
+        self._offset += length
+        return data
+
+    def read_string(self):
+        length, = self.unpack(_U16)
+        return self.read(length).decode('utf-8')
+
+
+def _decode_arg(reader):
+    tag, = reader.unpack(_U8)
+    if tag == _ARG_NONE:
+        return RecordedArg('none', None, None, None)
+    if tag == _ARG_INT:
+        return RecordedArg('int', reader.unpack(_I64)[0], None, None)
+    if tag == _ARG_BYTES:
+        length, = reader.unpack(_U32)
+        return RecordedArg('bytes', reader.read(length), None, None)
+    if tag == _ARG_CALLBACK:
+        return RecordedArg('callback', None, None, None)
+    if tag == _ARG_SCALAR_NONE:
+        return RecordedArg('scalar', None, None, None)
+    if tag == _ARG_SCALAR_FLOAT:
+        return RecordedArg('scalar', reader.unpack(_F64)[0], None, None)
+    if tag == _ARG_SCALAR_BYTES:
+        length, = reader.unpack(_U32)
+        return RecordedArg('scalar', reader.read(length), None, None)
+    if tag == _ARG_SCALAR:
+        return RecordedArg('scalar', reader.unpack(_I64)[0], None, None)
+    if tag == _ARG_BUFFER:
+        reader._offset -= _U8.size
+        _, size, digest, stored = reader.unpack(_BUFFER_HEADER)
+        return RecordedArg('buffer', reader.read(stored) if stored else None, size, digest)
+    raise ValueError('Unknown argument tag {} in recording.'.format(tag))
+
+
+def read_recording(file_path):
+    """
+    Reads a recording written by CallRecorder.
+
+    @param str file_path: Path of the recording.
+    @return (dict, [RecordedCall]): Type names of the owners by owner id, and the recorded calls in the order they ended.
+    """
+    with open(file_path, 'rb') as recording:
+        if recording.read(len(_MAGIC)) != _MAGIC:
+            raise ValueError('{} is not a pynrfjprog call recording.'.format(file_path))
+        # A recording that was not closed is read up to its last complete record.
+        reader = _Reader(zlib.decompressobj().decompress(recording.read()))
+
+    names = dict()
+    owners = dict()
+    messages = dict()
+    calls = list()
+
+    while not reader.at_end():
+        start_offset = reader._offset
+        try:
+            record_type, = reader.unpack(_U8)
+            if record_type == _NAME:
+                name_id, = reader.unpack(_U16)
+                names[name_id] = reader.read_string()
+            elif record_type == _OWNER:
+                owner_id, = reader.unpack(_U32)
+                owners[owner_id] = reader.read_string()
+            elif record_type == _MESSAGE:
+                reader._offset = start_offset
+                _, owner_id, level = reader.unpack(_MESSAGE_HEADER)
+                messages.setdefault(owner_id, list()).append((level, reader.read_string()))
+            elif record_type == _CALL:
+                reader._offset = start_offset
+                _, owner_id, name_id, start, duration, result, num_args = reader.unpack(_CALL_HEADER)
+                args = tuple(_decode_arg(reader) for _ in range(num_args))
+                calls.append(RecordedCall(owner_id, names[name_id], start, duration, result, args, messages.pop(owner_id, [])))
+            else:
+                raise ValueError('Unknown record type {} in recording.'.format(record_type))
+        except struct.error:
+            break
+
+    return owners, calls
+
+
+# Functions releasing handles, which succeed even when they do not match the recording.
+_RELEASE_FUNCTIONS = frozenset(['NRFJPROG_close_dll_inst', 'NRFJPROG_dll_close', 'NRFJPROG_probe_uninit'])
+
+
+def _handle_value(arg):
+    """ Returns the handle passed in a call argument, None if the argument is not a handle. """
+    arg = getattr(arg, '_obj', arg)
+    return arg.value if isinstance(arg, ctypes.c_void_p) else None
+
+
+class ReplayLibrary(object):
+    """
+    Stub nrfjprog library returning the results of a recording. Thread-safe.
+
+    The calls of each recorded API or probe are replayed in order. A call passing a handle is matched to the API or probe
+    the recording gave that handle to. Other calls, like the ones opening a handle, are matched to the API or probe whose
+    next recorded call has the same function name, the earliest recorded first.
+    """
+
+    def __init__(self, file_path, speed=1.0):
+        """
+        @param str file_path: Path of a recording written by CallRecorder.
+        @param (optional) float speed: Replay speed, 2.0 waits half the recorded durations. None does not wait.
+        """
+        self.owners, calls = read_recording(file_path)
+        self.speed = speed
+
+        self._queues = dict()
+        for call in calls:
+            self._queues.setdefault(call.owner, collections.deque()).append(call)
+        self._handles = dict()
+        self._log_callbacks = dict()
+        self._lock = threading.Lock()
+
+    def remaining(self):
+        """
+        @return int: Number of recorded calls not replayed yet.
+        """
+        with self._lock:
+            return sum(len(queue) for queue in self._queues.values())
+
+    def _next_call(self, name, args):
+        handle = _handle_value(args[0]) if args else None
+        owner = self._handles.get(handle) if handle is not None else None
+
+        if owner is not None:
+            queue = self._queues.get(owner)
+            if not queue or queue[0].name != name:
+                raise ReplayError('{} on handle {:#x} does not match the recording, which expects {}.'.format(
+                    name, handle, queue[0].name if queue else 'no more calls'))
+        else:
+            candidates = [(queue[0].start, owner) for owner, queue in self._queues.items() if queue and queue[0].name == name]
+            if not candidates:
+                raise ReplayError('{} does not match the next call of any recorded API or probe.'.format(name))
+            owner = min(candidates)[1]
+
+        return owner, self._queues[owner].popleft()
+
+    @staticmethod
+    def _fill(arg, recorded):
+        """ Sets an output argument to its recorded value. """
+        target = getattr(arg, '_obj', arg)
+        if recorded.kind == 'scalar' and isinstance(target, ctypes._SimpleCData):
+            target.value = recorded.value
+        elif recorded.kind == 'buffer' and recorded.value is not None and isinstance(target, (ctypes.Array, ctypes.Structure, ctypes.Union)):
+            ctypes.memmove(ctypes.addressof(target), recorded.value, min(len(recorded.value), ctypes.sizeof(target)))
+
+    def _replay(self, name, args):
+        with self._lock:
+            try:
+                owner, call = self._next_call(name, args)
+            except ReplayError:
+                # Instances can be closed after the replay diverged.
+                if name in _RELEASE_FUNCTIONS:
+                    return NrfjprogdllErr.SUCCESS
+                raise
+
+            for arg, recorded in zip(args, call.args):
+                if recorded.kind == 'callback' and isinstance(arg, ctypes._CFuncPtr):
+                    self._log_callbacks[owner] = arg
+                else:
+                    self._fill(arg, recorded)
+
+            handle = _handle_value(args[0]) if args else None
+            if handle is not None:
+                self._handles[handle] = owner
+            log_callback = self._log_callbacks.get(owner)
+
+        if log_callback is not None:
+            for level, message in call.messages:
+                log_callback(b'nrfjprog', int(_DLL_LOG_LEVELS.get(level, NrfjrpogdllLogLevel.info)), message.encode('utf-8'), None)
+
+        if self.speed and call.duration > 0:
+            time.sleep(call.duration / self.speed)
+        return call.result
+
+    def __getattr__(self, name):
+        if not name.startswith('NRFJPROG_'):
+            raise AttributeError(name)
+
+        def replay(*args):
+            return self._replay(name, args)
+
+        replay.__name__ = name
+        setattr(self, name, replay)
+        return replay
+
+
+class LowLevelAPI(LowLevel.API):
+    """ LowLevel.API replaying a recording. """
+
+    def __init__(self, device_family, library, **kwargs):
+        """
+        @param enum, str or int device_family: The series of device pynrfjprog will interact with.
+        @param ReplayLibrary library: Library replaying the recording.
+        Other keyword arguments are passed to LowLevel.API.
+        """
+        self._replay_library = library
+        super(LowLevelAPI, self).__init__(device_family, **kwargs)
+
+    def _load_library(self):
+        return self._replay_library
+
+
+class HighLevelAPI(HighLevel.API):
+    """ HighLevel.API replaying a recording. """
+
+    def __init__(self, library, log=True, trace=None):
+        """
+        @param ReplayLibrary library: Library replaying the recording.
+        @param (optional) bool log: See HighLevel.API.
+        @param (optional) str or Trace.TraceRecorder trace: See HighLevel.API.
+        """
+        self._replay_library = library
+        super(HighLevelAPI, self).__init__(log=log, trace=trace)
+
+    def _load_library(self):
+        return self._replay_library
@@ -0,0 +1,1143 @@
+"""
+This module simulates the nrfjprog libraries, so that the Python layer can be run and benchmarked without hardware.
+
+SimulatedDevice models one debug probe with an nRF device attached: code flash with NVMC write and erase rules, UICR,
+FICR, RAM sections with power state, external QSPI memory and RTT buffers. Delays can be injected per call and per
+byte transferred to approach the timing of a real probe.
+
+SimulatedLowLevelLibrary and SimulatedHighLevelLibrary implement the functions of nrfjprogdll.h and
+highlevelnrfjprogdll.h used by LowLevel.py and HighLevel.py on these devices, and take the same ctypes arguments.
+Functions that are not simulated return NOT_IMPLEMENTED_ERROR.
+
+LowLevelAPI and HighLevelAPI are LowLevel.API and HighLevel.API using the simulated libraries.
+
+Example:
+    devices = [Simulator.SimulatedDevice(682000001 + i, call_latency=0.0005, bytes_per_second=500000) for i in range(4)]
+
+    with Simulator.LowLevelAPI('NRF52', devices) as api:
+        api.connect_to_emu_with_snr(682000001)
+        api.program_file('image.hex')
+"""
+
+from __future__ import print_function
+
+import ctypes
+import functools
+import itertools
+import os
+import threading
+import time
+
+try:
+    from . import Hex
+    from . import HighLevel
+    from . import Instrumentation
+    from . import LowLevel
+    from .APIError import *
+    from .Parameters import *
+except Exception:
+    import Hex
+    import HighLevel
+    import Instrumentation
+    import LowLevel
+    from APIError import *
+    from Parameters import *
+
+
+FICR_ADDRESS = 0x10000000
+UICR_ADDRESS = 0x10001000
+INFO_PAGE_SIZE = 0x1000
+RAM_ADDRESS = 0x20000000
+
+# Offsets of the FICR registers filled in by the simulation.
+_FICR_CODEPAGESIZE = 0x010
+_FICR_CODESIZE = 0x014
+_FICR_DEVICEID = 0x060
+_FICR_INFO_PART = 0x100
+_FICR_INFO_RAM = 0x10C
+_FICR_INFO_FLASH = 0x110
+
+# Size of the sectors erased by each QSPIEraseLen value, ERASEALL erases the whole memory.
+_QSPI_ERASE_SIZES = {
+    QSPIEraseLen.ERASE4KB: 0x1000,
+    QSPIEraseLen.ERASE32KB: 0x8000,
+    QSPIEraseLen.ERASE64KB: 0x10000,
+}
+
+
+def _value(arg):
+    """ Returns the Python value of a ctypes argument. """
+    return arg.value if hasattr(arg, 'value') and not isinstance(arg, (ctypes.Array, ctypes.Structure)) else arg
+
+
+def _target(ref):
+    """ Returns the ctypes object referenced by a ctypes.byref() argument. """
+    return ref._obj if hasattr(ref, '_obj') else ref
+
+
+def _bytes_view(ref, length):
+    """ Returns a writable byte view of the first length bytes of the buffer referenced by ref. """
+    return memoryview(_target(ref)).cast('B')[:length]
+
+
+class SimulatedError(Exception):
+    """ Raised by the device model, converted to an error code by the simulated libraries. """
+
+    def __init__(self, err_code, message):
+        super(SimulatedError, self).__init__(message)
+        self.err_code = err_code
+
+
+class SimulatedDevice(object):
+    """
+    Debug probe with an nRF device attached. The memory layout defaults to an nRF52840.
+    Devices are thread-safe and can be shared between several simulated libraries.
+    """
+
+    def __init__(self, serial_number, family=DeviceFamily.NRF52, device_version=DeviceVersion.NRF52840_xxAA_REV2,
+                 flash_size=0x100000, page_size=0x1000, ram_size=0x40000, ram_sections=8, qspi_size=0x800000,
+                 rtt_channels=3, rtt_buffer_size=1024, call_latency=0.0, bytes_per_second=None, latencies=None):
+        """
+        Constructor.
+
+        @param int serial_number: Serial number of the debug probe.
+        @param (optional) DeviceFamily family: Family of the device.
+        @param (optional) DeviceVersion device_version: Version of the device.
+        @param (optional) int flash_size: Size in bytes of the code flash, at address 0.
+        @param (optional) int page_size: Size in bytes of the code flash pages.
+        @param (optional) int ram_size: Size in bytes of the data RAM, at RAM_ADDRESS.
+        @param (optional) int ram_sections: Number of RAM power sections of equal size.
+        @param (optional) int qspi_size: Size in bytes of the external QSPI memory.
+        @param (optional) int rtt_channels: Number of up and down RTT channels.
+        @param (optional) int rtt_buffer_size: Size in bytes of each RTT channel buffer. Like on the target, a buffer holds at most rtt_buffer_size - 1 bytes.
+        @param (optional) float call_latency: Delay in seconds added to each library call.
+        @param (optional) float bytes_per_second: Transfer rate of memory accesses. None transfers instantly.
+        @param (optional) dict latencies: Delay in seconds added to specific library calls, by function name without prefix and suffix, i.e. {'erase_all': 0.1}.
+        """
+        self.serial_number = serial_number
+        self.family = decode_enum(family, DeviceFamily)
+        self.device_version = device_version
+        self.page_size = page_size
+        self.call_latency = call_latency
+        self.bytes_per_second = bytes_per_second
+        self.latencies = dict(latencies or {})
+
+        self.flash = bytearray(b'\xFF' * flash_size)
+        self.uicr = bytearray(b'\xFF' * INFO_PAGE_SIZE)
+        self.ficr = bytearray(b'\xFF' * INFO_PAGE_SIZE)
+        self.ram = bytearray(ram_size)
+        self.ram_section_size = ram_size // ram_sections
+        self.ram_powered = [True] * ram_sections
+        self.qspi = bytearray(b'\xFF' * qspi_size)
+
+        self._set_ficr_u32(_FICR_CODEPAGESIZE, page_size)
+        self._set_ficr_u32(_FICR_CODESIZE, flash_size // page_size)
+        self._set_ficr_u32(_FICR_DEVICEID, serial_number)
+        self._set_ficr_u32(_FICR_INFO_PART, 0x52840)
+        self._set_ficr_u32(_FICR_INFO_RAM, ram_size // 1024)
+        self._set_ficr_u32(_FICR_INFO_FLASH, flash_size // 1024)
+
+        self.halted = False
+        self.registers = dict((register, 0) for register in CpuRegister)
+        self.readback_protection = ReadbackProtection.NONE
+        self.eraseprotect = False
+
+        # Up channels carry data from the device to the host, down channels from the host to the device.
+        self.rtt_buffer_size = rtt_buffer_size
+        self.rtt_up = [bytearray() for _ in range(rtt_channels)]
+        self.rtt_down = [bytearray() for _ in range(rtt_channels)]
+        self.rtt_started = False
+        self.rtt_control_block_address = None
+
+        # Number of flash writes that tried to set bits that were not erased.
+        self.nvmc_violations = 0
+
+        self.lock = threading.RLock()
+
+    def _set_ficr_u32(self, offset, value):
+        self.ficr[offset:offset + 4] = value.to_bytes(4, 'little')
+
+    def delay(self, function_name=None, num_bytes=0):
+        """
+        Sleeps for the injected latency of a call, and the time to transfer num_bytes.
+
+        @param (optional) str function_name: Function name without prefix and suffix, None to only wait for the transfer.
+        @param (optional) int num_bytes: Number of bytes transferred.
+        """
+        delay = 0.0
+        if function_name is not None:
+            delay += self.call_latency + self.latencies.get(function_name, 0.0)
+        if num_bytes and self.bytes_per_second:
+            delay += num_bytes / self.bytes_per_second
+        if delay > 0:
+            time.sleep(delay)
+
+    def _region(self, address, length):
+        """ Returns the memory type, buffer and offset of the region containing [address, address + length). """
+        regions = (
+            (MemoryType.CODE, 0, self.flash),
+            (MemoryType.UICR, UICR_ADDRESS, self.uicr),
+            (MemoryType.FICR, FICR_ADDRESS, self.ficr),
+            (MemoryType.DATA_RAM, RAM_ADDRESS, self.ram),
+        )
+        for memory_type, start, buffer in regions:
+            if start <= address and address + length <= start + len(buffer):
+                return memory_type, buffer, address - start
+        raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER,
+                             'Address range [{:#010x}-{:#010x}] is not mapped.'.format(address, address + length - 1))
+
+    def _check_ram_powered(self, offset, length):
+        first = offset // self.ram_section_size
+        last = (offset + length - 1) // self.ram_section_size
+        for section in range(first, last + 1):
+            if not self.ram_powered[section]:
+                raise SimulatedError(NrfjprogdllErr.RAM_IS_OFF_ERROR, 'RAM section {} is not powered.'.format(section))
+
+    def read(self, address, length):
+        """ Reads memory through the debug port. """
+        if self.readback_protection != ReadbackProtection.NONE:
+            raise SimulatedError(NrfjprogdllErr.NOT_AVAILABLE_BECAUSE_PROTECTION, 'Access protection is enabled.')
+
+        memory_type, buffer, offset = self._region(address, length)
+        if memory_type == MemoryType.DATA_RAM:
+            self._check_ram_powered(offset, length)
+        return memoryview(buffer)[offset:offset + length]
+
+    def write(self, address, data, control):
+        """ Writes memory. Flash is written through the NVMC when control is True, and bits can only be cleared. """
+        if self.readback_protection != ReadbackProtection.NONE:
+            raise SimulatedError(NrfjprogdllErr.NOT_AVAILABLE_BECAUSE_PROTECTION, 'Access protection is enabled.')
+
+        length = len(data)
+        memory_type, buffer, offset = self._region(address, length)
+
+        if memory_type == MemoryType.FICR:
+            raise SimulatedError(NrfjprogdllErr.INVALID_OPERATION, 'FICR is read-only.')
+
+        if memory_type == MemoryType.DATA_RAM:
+            self._check_ram_powered(offset, length)
+            buffer[offset:offset + length] = data
+            return
+
+        if not control:
+            raise SimulatedError(NrfjprogdllErr.NVMC_ERROR, 'Flash at {:#010x} can only be written through the NVMC.'.format(address))
+        if address % 4 or length % 4:
+            raise SimulatedError(NrfjprogdllErr.NVMC_ERROR, 'The NVMC writes whole words only.')
+
+        current = int.from_bytes(buffer[offset:offset + length], 'little')
+        new = int.from_bytes(data, 'little')
+        if new & ~current:
+            self.nvmc_violations += 1
+        buffer[offset:offset + length] = (current & new).to_bytes(length, 'little')
+
+    def write_ficr(self, address, data):
+        """ Writes FICR, as done by ficrwrite on devices that allow it. """
+        memory_type, buffer, offset = self._region(address, len(data))
+        if memory_type != MemoryType.FICR:
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'Address {:#010x} is not in FICR.'.format(address))
+        buffer[offset:offset + len(data)] = data
+
+    def erase_page(self, address):
+        if self.eraseprotect:
+            raise SimulatedError(NrfjprogdllErr.NOT_AVAILABLE_BECAUSE_PROTECTION, 'Erase protection is enabled.')
+        if address % self.page_size or not address < len(self.flash):
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'Address {:#010x} is not the start of a flash page.'.format(address))
+        self.flash[address:address + self.page_size] = b'\xFF' * self.page_size
+
+    def erase_uicr(self):
+        if self.eraseprotect:
+            raise SimulatedError(NrfjprogdllErr.NOT_AVAILABLE_BECAUSE_PROTECTION, 'Erase protection is enabled.')
+        self.uicr[:] = b'\xFF' * len(self.uicr)
+
+    def erase_all(self):
+        if self.eraseprotect:
+            raise SimulatedError(NrfjprogdllErr.NOT_AVAILABLE_BECAUSE_PROTECTION, 'Erase protection is enabled.')
+        self.flash[:] = b'\xFF' * len(self.flash)
+        self.uicr[:] = b'\xFF' * len(self.uicr)
+        self.readback_protection = ReadbackProtection.NONE
+
+    def recover(self):
+        self.eraseprotect = False
+        self.erase_all()
+        self.ram[:] = bytes(len(self.ram))
+        self.ram_powered = [True] * len(self.ram_powered)
+
+    def reset(self):
+        self.halted = False
+        self.rtt_started = False
+        self.ram_powered = [True] * len(self.ram_powered)
+
+    def memory_descriptions(self):
+        """ Returns (MemoryDescriptionStruct, [(page size, repeats)]) pairs of the device memories. """
+        rw = MemoryAccess.MEM_ACCESS_READ | MemoryAccess.MEM_ACCESS_WRITE
+        memories = (
+            (MemoryType.CODE, 0, len(self.flash), self.page_size, rw | MemoryAccess.MEM_ACCESS_EXECUTE | MemoryAccess.MEM_ACCESS_ERASE, b'FLASH'),
+            (MemoryType.UICR, UICR_ADDRESS, len(self.uicr), len(self.uicr), rw | MemoryAccess.MEM_ACCESS_ERASE, b'UICR'),
+            (MemoryType.FICR, FICR_ADDRESS, len(self.ficr), len(self.ficr), MemoryAccess.MEM_ACCESS_READ, b'FICR'),
+            (MemoryType.DATA_RAM, RAM_ADDRESS, len(self.ram), self.ram_section_size, rw | MemoryAccess.MEM_ACCESS_EXECUTE, b'RAM'),
+        )
+        result = list()
+        for index, (memory_type, start, size, page_size, access, label) in enumerate(memories):
+            description = MemoryDescriptionStruct(start=start, size=size, num_pages=size // page_size, type=memory_type,
+                                                  access_flags=int(access), _id=index + 1, label=label)
+            result.append((description, [(page_size, size // page_size)]))
+        return result
+
+    def rtt_send(self, channel_index, data):
+        """
+        Writes data from the device side into an RTT up channel, to be read by rtt_read.
+
+        @return int: Number of bytes accepted, limited by the free space of the channel buffer.
+        """
+        with self.lock:
+            buffer = self.rtt_up[channel_index]
+            accepted = max(0, min(len(data), self.rtt_buffer_size - 1 - len(buffer)))
+            buffer += data[:accepted]
+            return accepted
+
+    def rtt_receive(self, channel_index):
+        """
+        Reads, from the device side, the data written by the host into an RTT down channel.
+
+        @return bytes: Data received since the previous call.
+        """
+        with self.lock:
+            data = bytes(self.rtt_down[channel_index])
+            del self.rtt_down[channel_index][:]
+            return data
+
+    def load_image(self, file_path):
+        """
+        Parses an image file into (address, data) segments. .hex files are placed at their addresses, other files at address 0.
+        """
+        file_path = file_path.decode('utf-8') if isinstance(file_path, bytes) else str(file_path)
+        if os.path.splitext(file_path)[1].lower() == '.hex':
+            return [(segment.address, bytes(segment.data)) for segment in Hex.Hex(file_path)]
+        with open(file_path, 'rb') as image:
+            return [(0, image.read())]
+
+
+def _simulated(function):
+    """
+    Wraps a simulated library function: applies the injected latency, and converts SimulatedError into a logged error code.
+    The wrapped function receives the session or probe of the handle instead of the handle.
+    """
+    name = Instrumentation.short_name(function.__name__)
+
+    @functools.wraps(function)
+    def wrapper(self, handle, *args):
+        session = self._sessions.get(_value(_target(handle)))
+        if session is None:
+            return NrfjprogdllErr.INVALID_SESSION
+
+        device = session.device
+        if device is not None:
+            device.delay(name)
+
+        try:
+            result = function(self, session, *args)
+        except SimulatedError as error:
+            session.log(NrfjrpogdllLogLevel.error, str(error))
+            return error.err_code
+        return NrfjprogdllErr.SUCCESS if result is None else result
+
+    return wrapper
+
+
+class _Session(object):
+    """ State of one simulated DLL instance or probe handle. """
+
+    def __init__(self, log_cb, family=None, device=None):
+        self.log_cb = log_cb
+        self.family = family
+        self.device = device
+        self.device_connected = False
+
+    def log(self, level, message):
+        if self.log_cb:
+            self.log_cb(b'nrfjprog', int(level), message.encode('utf-8'), None)
+
+    def require_device(self):
+        if self.device is None:
+            raise SimulatedError(NrfjprogdllErr.EMULATOR_NOT_CONNECTED, 'No emulator is connected.')
+        # The DLL connects to the device on demand.
+        self.device_connected = True
+        return self.device
+
+
+class _SimulatedLibrary(object):
+    """ Functions shared by both simulated libraries. """
+
+    _handles = itertools.count(1)
+
+    def __init__(self, devices):
+        """
+        @param [SimulatedDevice] devices: Debug probes that can be connected to.
+        """
+        self.devices = dict((device.serial_number, device) for device in devices)
+        self._sessions = dict()
+
+    def __getattr__(self, name):
+        if not name.startswith('NRFJPROG_'):
+            raise AttributeError(name)
+
+        def not_implemented(*args):
+            return NrfjprogdllErr.NOT_IMPLEMENTED_ERROR
+        not_implemented.__name__ = name
+        return not_implemented
+
+    def _new_session(self, handle_ref, log_cb, family=None, device=None):
+        handle = next(self._handles)
+        _target(handle_ref).value = handle
+        self._sessions[handle] = _Session(log_cb, family, device)
+        return self._sessions[handle]
+
+    @staticmethod
+    def _program(session, file_path, progress_name='Programming'):
+        device = session.require_device()
+        segments = device.load_image(file_path)
+        total = sum(len(data) for _, data in segments)
+        session.log(NrfjrpogdllLogLevel.info, '{} file {}'.format(progress_name, os.path.basename(_decode_path(file_path))))
+        device.delay(num_bytes=total)
+        with device.lock:
+            for index, (address, data) in enumerate(segments):
+                # Pad to whole words with erased bytes, as the NVMC writes words.
+                padding = -len(data) % 4
+                device.write(address, data + b'\xFF' * padding, True)
+                session.log(NrfjrpogdllLogLevel.info, 'Loaded block {} of {} in segment 0.'.format(index + 1, len(segments)))
+
+    @staticmethod
+    def _erase_for_image(session, file_path):
+        device = session.require_device()
+        with device.lock:
+            for address, data in device.load_image(file_path):
+                if address >= UICR_ADDRESS:
+                    device.erase_uicr()
+                    continue
+                first = address - address % device.page_size
+                for page in range(first, address + len(data), device.page_size):
+                    session.log(NrfjrpogdllLogLevel.info, 'Erasing flash range [{:#010x}-{:#010x}]'.format(page, page + device.page_size - 1))
+                    device.erase_page(page)
+
+    @staticmethod
+    def _verify(session, file_path):
+        device = session.require_device()
+        segments = device.load_image(file_path)
+        session.log(NrfjrpogdllLogLevel.info, 'Verifying file {}'.format(os.path.basename(_decode_path(file_path))))
+        device.delay(num_bytes=sum(len(data) for _, data in segments))
+        with device.lock:
+            for index, (address, data) in enumerate(segments):
+                session.log(NrfjrpogdllLogLevel.info, 'Verifying memory range {} of {}'.format(index + 1, len(segments)))
+                if device.read(address, len(data)) != data:
+                    raise SimulatedError(NrfjprogdllErr.VERIFY_ERROR, 'Verify failure at segment {:#010x}.'.format(address))
+
+    @staticmethod
+    def _read(session, address, data, length):
+        device = session.require_device()
+        device.delay(num_bytes=length)
+        with device.lock:
+            _bytes_view(data, length)[:] = device.read(address, length)
+
+    @staticmethod
+    def _write(session, address, data, length, control):
+        device = session.require_device()
+        device.delay(num_bytes=length)
+        with device.lock:
+            device.write(address, bytes(_bytes_view(data, length)), control)
+
+    @staticmethod
+    def _rtt_read(session, channel_index, data, length, data_read):
+        device = session.require_device()
+        if not device.rtt_started:
+            raise SimulatedError(NrfjprogdllErr.INVALID_OPERATION, 'RTT is not started.')
+        if not channel_index < len(device.rtt_up):
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'RTT channel {} does not exist.'.format(channel_index))
+        with device.lock:
+            buffer = device.rtt_up[channel_index]
+            count = min(length, len(buffer))
+            _bytes_view(data, count)[:] = buffer[:count]
+            del buffer[:count]
+        device.delay(num_bytes=count)
+        _target(data_read).value = count
+
+    @staticmethod
+    def _rtt_write(session, channel_index, data, length, data_written):
+        device = session.require_device()
+        if not device.rtt_started:
+            raise SimulatedError(NrfjprogdllErr.INVALID_OPERATION, 'RTT is not started.')
+        if not channel_index < len(device.rtt_down):
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'RTT channel {} does not exist.'.format(channel_index))
+        with device.lock:
+            buffer = device.rtt_down[channel_index]
+            count = max(0, min(length, device.rtt_buffer_size - 1 - len(buffer)))
+            buffer += _bytes_view(data, count)
+        device.delay(num_bytes=count)
+        _target(data_written).value = count
+
+    @staticmethod
+    def _rtt_channel_info(session, channel_index, direction, name, name_len, size):
+        device = session.require_device()
+        channels = device.rtt_up if direction == RTTChannelDirection.UP_DIRECTION else device.rtt_down
+        if not channel_index < len(channels):
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'RTT channel {} does not exist.'.format(channel_index))
+        label = (b'Terminal' if channel_index == 0 else 'Channel{}'.format(channel_index).encode('ascii'))[:name_len - 1]
+        _bytes_view(name, len(label))[:] = label
+        _target(size).value = device.rtt_buffer_size
+
+
+def _decode_path(file_path):
+    return file_path.decode('utf-8') if isinstance(file_path, bytes) else str(file_path)
+
+
+class SimulatedLowLevelLibrary(_SimulatedLibrary):
+    """ Simulation of the NRFJPROG_*_inst functions of nrfjprogdll.h. """
+
+    def NRFJPROG_open_dll_inst(self, handle, jlink_path, log_cb, log_param, family):
+        self._new_session(handle, log_cb, _value(family))
+        return NrfjprogdllErr.SUCCESS
+
+    def NRFJPROG_close_dll_inst(self, handle):
+        self._sessions.pop(_value(_target(handle)), None)
+        _target(handle).value = None
+
+    def NRFJPROG_is_dll_open_inst(self, handle, opened):
+        _target(opened).value = _value(handle) in self._sessions
+        return NrfjprogdllErr.SUCCESS
+
+    def NRFJPROG_dll_version_inst(self, handle, major, minor, revision):
+        _target(major).value = 10
+        _target(minor).value = 15
+        _target(revision).value = ord('4')
+        return NrfjprogdllErr.SUCCESS
+
+    @_simulated
+    def NRFJPROG_enum_emu_snr_inst(self, session, serial_numbers, serial_numbers_len, num_available):
+        serial_numbers = _target(serial_numbers)
+        for index, serial_number in enumerate(sorted(self.devices)[:_value(serial_numbers_len)]):
+            serial_numbers[index] = serial_number
+        _target(num_available).value = len(self.devices)
+
+    @_simulated
+    def NRFJPROG_enum_emu_com_inst(self, session, serial_number, com_ports, com_ports_len, num_available):
+        _target(num_available).value = 0
+
+    @_simulated
+    def NRFJPROG_is_connected_to_emu_inst(self, session, is_connected):
+        _target(is_connected).value = session.device is not None
+
+    @_simulated
+    def NRFJPROG_connect_to_emu_with_snr_inst(self, session, serial_number, jlink_speed_khz):
+        device = self.devices.get(_value(serial_number))
+        if device is None:
+            raise SimulatedError(NrfjprogdllErr.EMULATOR_NOT_CONNECTED, 'No emulator with serial number {}.'.format(_value(serial_number)))
+        session.device = device
+        device.delay('connect_to_emu_with_snr')
+
+    @_simulated
+    def NRFJPROG_connect_to_emu_without_snr_inst(self, session, jlink_speed_khz):
+        if len(self.devices) != 1:
+            raise SimulatedError(NrfjprogdllErr.NO_EMULATOR_CONNECTED, 'Expected exactly one emulator, found {}.'.format(len(self.devices)))
+        session.device = next(iter(self.devices.values()))
+        session.device.delay('connect_to_emu_without_snr')
+
+    @_simulated
+    def NRFJPROG_read_connected_emu_snr_inst(self, session, serial_number):
+        _target(serial_number).value = session.require_device().serial_number
+
+    @_simulated
+    def NRFJPROG_read_connected_emu_fwstr_inst(self, session, fwstr, buffer_size):
+        session.require_device()
+        text = b'Simulated J-Link'[:_value(buffer_size) - 1]
+        _bytes_view(fwstr, len(text))[:] = text
+
+    @_simulated
+    def NRFJPROG_reset_connected_emu_inst(self, session):
+        session.require_device()
+
+    @_simulated
+    def NRFJPROG_replace_connected_emu_fw_inst(self, session):
+        session.require_device()
+
+    @_simulated
+    def NRFJPROG_disconnect_from_emu_inst(self, session):
+        session.device = None
+        session.device_connected = False
+
+    @_simulated
+    def NRFJPROG_select_family_inst(self, session, family):
+        session.family = _value(family)
+
+    @_simulated
+    def NRFJPROG_select_coprocessor_inst(self, session, coprocessor):
+        pass
+
+    @_simulated
+    def NRFJPROG_is_coprocessor_enabled_inst(self, session, coprocessor, enabled):
+        _target(enabled).value = True
+
+    @_simulated
+    def NRFJPROG_enable_coprocessor_inst(self, session, coprocessor):
+        pass
+
+    @_simulated
+    def NRFJPROG_disable_coprocessor_inst(self, session, coprocessor):
+        pass
+
+    @_simulated
+    def NRFJPROG_connect_to_device_inst(self, session):
+        session.require_device()
+
+    @_simulated
+    def NRFJPROG_disconnect_from_device_inst(self, session):
+        session.device_connected = False
+
+    @_simulated
+    def NRFJPROG_is_connected_to_device_inst(self, session, is_connected):
+        _target(is_connected).value = session.device_connected
+
+    @_simulated
+    def NRFJPROG_read_device_family_inst(self, session, family):
+        _target(family).value = int(session.require_device().family)
+
+    @_simulated
+    def NRFJPROG_read_device_version_inst(self, session, version):
+        _target(version).value = int(session.require_device().device_version)
+
+    @_simulated
+    def NRFJPROG_read_device_info_inst(self, session, version, name, memory, revision):
+        _target(version).value = int(session.require_device().device_version)
+
+    @_simulated
+    def NRFJPROG_readback_protect_inst(self, session, protection):
+        session.require_device().readback_protection = ReadbackProtection(_value(protection))
+
+    @_simulated
+    def NRFJPROG_readback_status_inst(self, session, status):
+        _target(status).value = int(session.require_device().readback_protection)
+
+    @_simulated
+    def NRFJPROG_read_region_0_size_and_source_inst(self, session, size, source):
+        session.require_device()
+        _target(size).value = 0
+        _target(source).value = 0
+
+    @_simulated
+    def NRFJPROG_enable_eraseprotect_inst(self, session):
+        session.require_device().eraseprotect = True
+
+    @_simulated
+    def NRFJPROG_is_eraseprotect_enabled_inst(self, session, status):
+        _target(status).value = session.require_device().eraseprotect
+
+    @_simulated
+    def NRFJPROG_is_bprot_enabled_inst(self, session, bprot_enabled, address_start, length):
+        session.require_device()
+        _target(bprot_enabled).value = False
+
+    @_simulated
+    def NRFJPROG_disable_bprot_inst(self, session):
+        session.require_device()
+
+    @_simulated
+    def NRFJPROG_debug_reset_inst(self, session):
+        session.require_device().reset()
+
+    @_simulated
+    def NRFJPROG_sys_reset_inst(self, session):
+        session.require_device().reset()
+
+    @_simulated
+    def NRFJPROG_pin_reset_inst(self, session):
+        session.require_device().reset()
+
+    @_simulated
+    def NRFJPROG_recover_inst(self, session):
+        session.require_device().recover()
+
+    @_simulated
+    def NRFJPROG_erase_all_inst(self, session):
+        session.require_device().erase_all()
+
+    @_simulated
+    def NRFJPROG_masserase_inst(self, session):
+        session.require_device().erase_all()
+
+    @_simulated
+    def NRFJPROG_erase_page_inst(self, session, address):
+        session.require_device().erase_page(_value(address))
+
+    @_simulated
+    def NRFJPROG_erase_uicr_inst(self, session):
+        session.require_device().erase_uicr()
+
+    @_simulated
+    def NRFJPROG_write_u32_inst(self, session, address, data, control):
+        self._write(session, _value(address), (ctypes.c_uint32 * 1)(_value(data)), 4, _value(control))
+
+    @_simulated
+    def NRFJPROG_read_u32_inst(self, session, address, data):
+        self._read(session, _value(address), data, 4)
+
+    @_simulated
+    def NRFJPROG_write_inst(self, session, address, data, data_len, control):
+        self._write(session, _value(address), data, _value(data_len), _value(control))
+
+    @_simulated
+    def NRFJPROG_read_inst(self, session, address, data, data_len):
+        self._read(session, _value(address), data, _value(data_len))
+
+    @_simulated
+    def NRFJPROG_ficrwrite_u32_inst(self, session, address, data):
+        session.require_device().write_ficr(_value(address), _value(data).to_bytes(4, 'little'))
+
+    @_simulated
+    def NRFJPROG_ficrwrite_inst(self, session, address, data, data_len):
+        session.require_device().write_ficr(_value(address), bytes(_bytes_view(data, _value(data_len))))
+
+    @_simulated
+    def NRFJPROG_is_halted_inst(self, session, is_halted):
+        _target(is_halted).value = session.require_device().halted
+
+    @_simulated
+    def NRFJPROG_halt_inst(self, session):
+        session.require_device().halted = True
+
+    @_simulated
+    def NRFJPROG_run_inst(self, session, pc, sp):
+        device = session.require_device()
+        device.registers[CpuRegister.PC] = _value(pc)
+        device.registers[CpuRegister.SP] = _value(sp)
+        device.halted = False
+
+    @_simulated
+    def NRFJPROG_go_inst(self, session):
+        session.require_device().halted = False
+
+    @_simulated
+    def NRFJPROG_step_inst(self, session):
+        device = session.require_device()
+        if not device.halted:
+            raise SimulatedError(NrfjprogdllErr.INVALID_OPERATION, 'The device is not halted.')
+        device.registers[CpuRegister.PC] += 2
+
+    @_simulated
+    def NRFJPROG_read_cpu_register_inst(self, session, register_name, value):
+        _target(value).value = session.require_device().registers[CpuRegister(_value(register_name))]
+
+    @_simulated
+    def NRFJPROG_write_cpu_register_inst(self, session, register_name, value):
+        session.require_device().registers[CpuRegister(_value(register_name))] = _value(value)
+
+    @_simulated
+    def NRFJPROG_read_ram_sections_count_inst(self, session, count):
+        _target(count).value = len(session.require_device().ram_powered)
+
+    @_simulated
+    def NRFJPROG_read_ram_sections_size_inst(self, session, sizes, sizes_len):
+        device = session.require_device()
+        sizes = _target(sizes)
+        for index in range(min(_value(sizes_len), len(device.ram_powered))):
+            sizes[index] = device.ram_section_size
+
+    @_simulated
+    def NRFJPROG_read_ram_sections_power_status_inst(self, session, status, status_len):
+        device = session.require_device()
+        status = _target(status)
+        for index in range(min(_value(status_len), len(device.ram_powered))):
+            status[index] = RamPower.ON if device.ram_powered[index] else RamPower.OFF
+
+    @_simulated
+    def NRFJPROG_power_ram_all_inst(self, session):
+        device = session.require_device()
+        device.ram_powered = [True] * len(device.ram_powered)
+
+    @_simulated
+    def NRFJPROG_unpower_ram_section_inst(self, session, section_index):
+        device = session.require_device()
+        section_index = _value(section_index)
+        if not section_index < len(device.ram_powered):
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'RAM section {} does not exist.'.format(section_index))
+        device.ram_powered[section_index] = False
+
+    @_simulated
+    def NRFJPROG_read_memory_descriptors_inst(self, session, descriptions, descriptions_len, num_available):
+        memories = session.require_device().memory_descriptions()
+        if descriptions is not None:
+            descriptions = _target(descriptions)
+            for index, (description, _) in enumerate(memories[:_value(descriptions_len)]):
+                descriptions[index] = description
+        _target(num_available).value = len(memories)
+
+    @_simulated
+    def NRFJPROG_read_page_sizes_inst(self, session, description, page_repetitions, page_repetitions_len, num_available):
+        description = _target(description)
+        for memory, pages in session.require_device().memory_descriptions():
+            if memory._id == description._id:
+                break
+        else:
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'Unknown memory description.')
+
+        if page_repetitions is not None:
+            page_repetitions = _target(page_repetitions)
+            for index, (size, repeats) in enumerate(pages[:_value(page_repetitions_len)]):
+                page_repetitions[index] = PageRepetitionsStruct(size, repeats)
+        _target(num_available).value = len(pages)
+
+    @_simulated
+    def NRFJPROG_program_file_inst(self, session, file_path):
+        self._program(session, file_path)
+
+    @_simulated
+    def NRFJPROG_verify_file_inst(self, session, file_path, verify_action):
+        if _value(verify_action) != VerifyAction.VERIFY_NONE:
+            self._verify(session, file_path)
+
+    @_simulated
+    def NRFJPROG_erase_file_inst(self, session, file_path, chip_erase_mode, qspi_erase_mode):
+        chip_erase_mode = _value(chip_erase_mode)
+        if chip_erase_mode == EraseAction.ERASE_ALL:
+            session.require_device().erase_all()
+        elif chip_erase_mode != EraseAction.ERASE_NONE:
+            self._erase_for_image(session, file_path)
+
+    @_simulated
+    def NRFJPROG_rtt_set_control_block_address_inst(self, session, address):
+        session.require_device().rtt_control_block_address = _value(address)
+
+    @_simulated
+    def NRFJPROG_rtt_start_inst(self, session):
+        session.require_device().rtt_started = True
+
+    @_simulated
+    def NRFJPROG_is_rtt_started_inst(self, session, started):
+        _target(started).value = session.require_device().rtt_started
+
+    @_simulated
+    def NRFJPROG_rtt_is_control_block_found_inst(self, session, found):
+        _target(found).value = session.require_device().rtt_started
+
+    @_simulated
+    def NRFJPROG_rtt_stop_inst(self, session):
+        session.require_device().rtt_started = False
+
+    @_simulated
+    def NRFJPROG_rtt_read_inst(self, session, channel_index, data, data_len, data_read):
+        self._rtt_read(session, _value(channel_index), data, _value(data_len), data_read)
+
+    @_simulated
+    def NRFJPROG_rtt_write_inst(self, session, channel_index, data, data_len, data_written):
+        self._rtt_write(session, _value(channel_index), data, _value(data_len), data_written)
+
+    @_simulated
+    def NRFJPROG_rtt_read_channel_count_inst(self, session, down_channels, up_channels):
+        device = session.require_device()
+        _target(down_channels).value = len(device.rtt_down)
+        _target(up_channels).value = len(device.rtt_up)
+
+    @_simulated
+    def NRFJPROG_rtt_read_channel_info_inst(self, session, channel_index, direction, name, name_len, size):
+        self._rtt_channel_info(session, _value(channel_index), _value(direction), name, _value(name_len), size)
+
+    def _qspi(self, session):
+        device = session.require_device()
+        if not getattr(session, 'qspi_initialized', False):
+            raise SimulatedError(NrfjprogdllErr.INVALID_OPERATION, 'QSPI is not initialized.')
+        return device
+
+    @_simulated
+    def NRFJPROG_qspi_init_inst(self, session, retain_ram, init_params):
+        session.require_device()
+        session.qspi_initialized = True
+
+    @_simulated
+    def NRFJPROG_qspi_init_ini_inst(self, session, ini_path):
+        session.require_device()
+        session.qspi_initialized = True
+
+    @_simulated
+    def NRFJPROG_qspi_uninit_inst(self, session):
+        session.qspi_initialized = False
+
+    @_simulated
+    def NRFJPROG_is_qspi_init_inst(self, session, initialized):
+        _target(initialized).value = getattr(session, 'qspi_initialized', False)
+
+    @_simulated
+    def NRFJPROG_qspi_get_size_inst(self, session, size):
+        _target(size).value = len(session.require_device().qspi)
+
+    @_simulated
+    def NRFJPROG_qspi_read_inst(self, session, address, data, data_len):
+        device = self._qspi(session)
+        address, data_len = _value(address), _value(data_len)
+        if address + data_len > len(device.qspi):
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'QSPI range out of bounds.')
+        device.delay(num_bytes=data_len)
+        with device.lock:
+            _bytes_view(data, data_len)[:] = device.qspi[address:address + data_len]
+
+    @_simulated
+    def NRFJPROG_qspi_write_inst(self, session, address, data, data_len):
+        device = self._qspi(session)
+        address, data_len = _value(address), _value(data_len)
+        if address + data_len > len(device.qspi):
+            raise SimulatedError(NrfjprogdllErr.INVALID_PARAMETER, 'QSPI range out of bounds.')
+        device.delay(num_bytes=data_len)
+        with device.lock:
+            current = int.from_bytes(device.qspi[address:address + data_len], 'little')
+            new = int.from_bytes(_bytes_view(data, data_len), 'little')
+            device.qspi[address:address + data_len] = (current & new).to_bytes(data_len, 'little')
+
+    @_simulated
+    def NRFJPROG_qspi_erase_inst(self, session, address, length):
+        device = self._qspi(session)
+        address, length = _value(address), _value(length)
+        if length == QSPIEraseLen.ERASEALL:
+            start, size = 0, len(device.qspi)
+        else:
+            size = _QSPI_ERASE_SIZES[QSPIEraseLen(length)]
+            start = address - address % size
+        with device.lock:
+            device.qspi[start:start + size] = b'\xFF' * size
+
+
+class SimulatedHighLevelLibrary(_SimulatedLibrary):
+    """ Simulation of the probe functions of highlevelnrfjprogdll.h for debug probes. """
+
+    def __init__(self, devices):
+        super(SimulatedHighLevelLibrary, self).__init__(devices)
+        self._open = False
+        self._log_cb = None
+
+    def NRFJPROG_dll_open_ex(self, jlink_path, log_cb, log_param):
+        self._open = True
+        self._log_cb = log_cb
+        return NrfjprogdllErr.SUCCESS
+
+    def NRFJPROG_dll_close(self):
+        self._open = False
+        self._sessions.clear()
+
+    def NRFJPROG_is_dll_open(self, opened):
+        _target(opened).value = self._open
+        return NrfjprogdllErr.SUCCESS
+
+    def NRFJPROG_dll_version(self, major, minor, micro):
+        _target(major).value = 10
+        _target(minor).value = 15
+        _target(micro).value = 4
+        return NrfjprogdllErr.SUCCESS
+
+    def NRFJPROG_get_connected_probes(self, serial_numbers, serial_numbers_len, num_available):
+        serial_numbers = _target(serial_numbers)
+        for index, serial_number in enumerate(sorted(self.devices)[:_value(serial_numbers_len)]):
+            serial_numbers[index] = serial_number
+        _target(num_available).value = len(self.devices)
+        return NrfjprogdllErr.SUCCESS
+
+    def NRFJPROG_probe_init_ex(self, handle, log_param, log_cb, param, serial_number, clock_speed, jlink_path):
+        device = self.devices.get(_value(serial_number))
+        if device is None:
+            return NrfjprogdllErr.EMULATOR_NOT_CONNECTED
+        device.delay('probe_init')
+        self._new_session(handle, log_cb, device.family, device)
+        return NrfjprogdllErr.SUCCESS
+
+    def NRFJPROG_probe_uninit(self, handle):
+        self._sessions.pop(_value(_target(handle)), None)
+        return NrfjprogdllErr.SUCCESS
+
+    @_simulated
+    def NRFJPROG_get_library_info(self, session, library_info):
+        _target(library_info).version_major = 10
+
+    @_simulated
+    def NRFJPROG_get_probe_info(self, session, probe_info):
+        probe_info = _target(probe_info)
+        probe_info.serial_number = session.device.serial_number
+        probe_info.firmware_string = b'Simulated J-Link'
+
+    @_simulated
+    def NRFJPROG_get_device_info(self, session, device_info):
+        device = session.require_device()
+        device_info = _target(device_info)
+        device_info.device_family = int(device.family)
+        device_info.device_type = int(device.device_version)
+        device_info.code_page_size = device.page_size
+        device_info.code_size = len(device.flash)
+        device_info.uicr_address = UICR_ADDRESS
+        device_info.info_page_size = INFO_PAGE_SIZE
+        device_info.data_ram_address = RAM_ADDRESS
+        device_info.ram_size = len(device.ram)
+
+    @_simulated
+    def NRFJPROG_probe_reset(self, session):
+        pass
+
+    @_simulated
+    def NRFJPROG_probe_replace_fw(self, session):
+        pass
+
+    @_simulated
+    def NRFJPROG_probe_set_coprocessor(self, session, coprocessor):
+        pass
+
+    @_simulated
+    def NRFJPROG_get_readback_protection(self, session, protection):
+        _target(protection).value = int(session.require_device().readback_protection)
+
+    @_simulated
+    def NRFJPROG_readback_protect(self, session, protection):
+        session.require_device().readback_protection = ReadbackProtection(_value(protection))
+
+    @_simulated
+    def NRFJPROG_is_eraseprotect_enabled(self, session, status):
+        _target(status).value = session.require_device().eraseprotect
+
+    @_simulated
+    def NRFJPROG_enable_eraseprotect(self, session):
+        session.require_device().eraseprotect = True
+
+    @_simulated
+    def NRFJPROG_program(self, session, file_path, program_options):
+        options = _target(program_options)
+        if options.erase_action == EraseAction.ERASE_ALL:
+            session.log(NrfjrpogdllLogLevel.info, 'Erasing user code and UICR flash areas.')
+            session.require_device().erase_all()
+        elif options.erase_action != EraseAction.ERASE_NONE:
+            self._erase_for_image(session, file_path)
+
+        self._program(session, file_path)
+
+        if options.verify != VerifyAction.VERIFY_NONE:
+            self._verify(session, file_path)
+        if options.reset != ResetAction.RESET_NONE:
+            session.require_device().reset()
+
+    @_simulated
+    def NRFJPROG_verify(self, session, file_path, verify_action):
+        if _value(verify_action) != VerifyAction.VERIFY_NONE:
+            self._verify(session, file_path)
+
+    @_simulated
+    def NRFJPROG_erase(self, session, erase_action, start_address, end_address):
+        device = session.require_device()
+        erase_action = _value(erase_action)
+        if erase_action == EraseAction.ERASE_ALL:
+            device.erase_all()
+        elif erase_action in (EraseAction.ERASE_SECTOR, EraseAction.ERASE_SECTOR_AND_UICR):
+            start = _value(start_address) - _value(start_address) % device.page_size
+            with device.lock:
+                for page in range(start, _value(end_address) + 1, device.page_size):
+                    if UICR_ADDRESS <= page < UICR_ADDRESS + INFO_PAGE_SIZE:
+                        # The UICR is only erased with ERASE_SECTOR_AND_UICR, below.
+                        if erase_action != EraseAction.ERASE_SECTOR_AND_UICR:
+                            raise SimulatedError(NrfjprogdllErr.INVALID_OPERATION, 'UICR erase requested in ERASE_SECTOR mode.')
+                        continue
+                    session.log(NrfjrpogdllLogLevel.info, 'Erasing flash range [{:#010x}-{:#010x}]'.format(page, page + device.page_size - 1))
+                    device.erase_page(page)
+                if erase_action == EraseAction.ERASE_SECTOR_AND_UICR:
+                    device.erase_uicr()
+
+    @_simulated
+    def NRFJPROG_recover(self, session):
+        session.require_device().recover()
+
+    @_simulated
+    def NRFJPROG_read(self, session, address, data, data_len):
+        self._read(session, _value(address), data, _value(data_len))
+
+    @_simulated
+    def NRFJPROG_read_u32(self, session, address, data):
+        self._read(session, _value(address), data, 4)
+
+    @_simulated
+    def NRFJPROG_write(self, session, address, data, data_len):
+        # The highlevel DLL uses the NVMC automatically when writing to flash.
+        self._write(session, _value(address), data, _value(data_len), True)
+
+    @_simulated
+    def NRFJPROG_write_u32(self, session, address, data):
+        self._write(session, _value(address), (ctypes.c_uint32 * 1)(_value(data)), 4, True)
+
+    @_simulated
+    def NRFJPROG_reset(self, session, reset_action):
+        if _value(reset_action) != ResetAction.RESET_NONE:
+            session.require_device().reset()
+
+    @_simulated
+    def NRFJPROG_run(self, session, pc, sp):
+        device = session.require_device()
+        device.registers[CpuRegister.PC] = _value(pc)
+        device.registers[CpuRegister.SP] = _value(sp)
+        device.halted = False
+
+    @_simulated
+    def NRFJPROG_rtt_set_control_block_address(self, session, address):
+        session.require_device().rtt_control_block_address = _value(address)
+
+    @_simulated
+    def NRFJPROG_rtt_start(self, session):
+        session.require_device().rtt_started = True
+
+    @_simulated
+    def NRFJPROG_is_rtt_started(self, session, started):
+        _target(started).value = session.require_device().rtt_started
+
+    @_simulated
+    def NRFJPROG_rtt_is_control_block_found(self, session, found):
+        _target(found).value = session.require_device().rtt_started
+
+    @_simulated
+    def NRFJPROG_rtt_stop(self, session):
+        session.require_device().rtt_started = False
+
+    @_simulated
+    def NRFJPROG_rtt_read(self, session, channel_index, data, data_len, data_read):
+        self._rtt_read(session, _value(channel_index), data, _value(data_len), data_read)
+
+    @_simulated
+    def NRFJPROG_rtt_write(self, session, channel_index, data, data_len, data_written):
+        self._rtt_write(session, _value(channel_index), data, _value(data_len), data_written)
+
+    @_simulated
+    def NRFJPROG_rtt_read_channel_count(self, session, down_channels, up_channels):
+        device = session.require_device()
+        _target(down_channels).value = len(device.rtt_down)
+        _target(up_channels).value = len(device.rtt_up)
+
+    @_simulated
+    def NRFJPROG_rtt_read_channel_info(self, session, channel_index, direction, name, name_len, size):
+        self._rtt_channel_info(session, _value(channel_index), _value(direction), name, _value(name_len), size)
+
+
+class LowLevelAPI(LowLevel.API):
+    """ LowLevel.API running on SimulatedDevice objects instead of debug probes. """
+
+    def __init__(self, device_family, devices, **kwargs):
+        """
+        @param enum, str or int device_family: The series of device pynrfjprog will interact with.
+        @param [SimulatedDevice] devices: Debug probes that can be connected to.
+        Other keyword arguments are passed to LowLevel.API.
+        """
+        self._simulated_library = SimulatedLowLevelLibrary(devices)
+        super(LowLevelAPI, self).__init__(device_family, **kwargs)
+
+    def _load_library(self):
+        return self._simulated_library
+
+
+class HighLevelAPI(HighLevel.API):
+    """ HighLevel.API running on SimulatedDevice objects instead of debug probes. """
+
+    def __init__(self, devices, log=True, trace=None):
+        """
+        @param [SimulatedDevice] devices: Debug probes that can be connected to.
+        @param (optional) bool log: See HighLevel.API.
+        @param (optional) str or Trace.TraceRecorder trace: See HighLevel.API.
+        """
+        self._simulated_library = SimulatedHighLevelLibrary(devices)
+        super(HighLevelAPI, self).__init__(log=log, trace=trace)
+
+    def _load_library(self):
+        return self._simulated_library
@@ -0,0 +1,179 @@
+"""
+This module records the DLL calls of LowLevel and HighLevel instances as a Chrome trace_event timeline.
+
+A TraceRecorder is a call observer, see Instrumentation.py. Each DLL call becomes a span on the track of the instance
+that made it, named after the serial number of its debug probe once it is known. The erase, program and verify phases
+logged by the DLL become nested spans inside the call. The saved JSON file can be opened with chrome://tracing or
+https://ui.perfetto.dev.
+
+The recorder keeps the most recent max_events events, 100000 by default, in a ring buffer: in a long session the oldest
+events are dropped and counted in the saved file, so the memory used stays bounded.
+
+LowLevel.API and HighLevel.API take a trace parameter. A file path records the instance and the probes it creates, and is
+written when the API is closed. A TraceRecorder can be shared by several APIs to get one timeline, and saved with save().
+
+Example:
+    trace = Trace.TraceRecorder()
+    apis = [LowLevel.API('NRF52', trace=trace) for _ in serial_numbers]
+    ...
+    trace.save('rack.json')
+"""
+
+from __future__ import print_function
+
+import collections
+import json
+import logging
+import os
+import threading
+import time
+import weakref
+
+try:
+    from . import Instrumentation
+    from . import Progress
+except Exception:
+    import Instrumentation
+    import Progress
+
+
+# Functions whose arguments tell the serial number of the debug probe, and the index of that argument.
+_SERIAL_NUMBER_ARGUMENTS = {
+    'NRFJPROG_connect_to_emu_with_snr_inst': 1,
+    'NRFJPROG_read_connected_emu_snr_inst': 1,
+    'NRFJPROG_probe_init_ex': 4,
+}
+
+
+def _value(arg):
+    arg = getattr(arg, '_obj', arg)
+    return getattr(arg, 'value', arg)
+
+
+class _Track(object):
+    """ Track of one API or probe. """
+
+    def __init__(self, owner, tid, name):
+        self.owner = weakref.ref(owner)
+        self.tid = tid
+        self.name = name
+        # (phase, start) of the phase in progress, None outside phases.
+        self.phase = None
+        self.listener = None
+
+
+class TraceRecorder(object):
+    """
+    Call observer recording a Chrome trace_event timeline. Thread-safe.
+    Events are kept in a ring buffer of max_events events. When it is full the oldest event is dropped for each new one.
+    """
+
+    def __init__(self, process_name='pynrfjprog', max_events=100000):
+        """
+        @param (optional) str process_name: Name of the process shown in the timeline.
+        @param (optional) int max_events: Number of most recent events kept. None keeps all the events.
+        """
+        self.process_name = process_name
+        self.max_events = max_events
+        self._events = collections.deque(maxlen=max_events)
+        # Number of events dropped from the ring buffer.
+        self.dropped_events = 0
+        self._tracks = dict()
+        self._track_list = list()
+        self._origin = time.perf_counter()
+        self._lock = threading.Lock()
+
+    def _timestamp(self, perf_counter):
+        """ Microseconds since the creation of the recorder, the time unit of trace_event. """
+        return (perf_counter - self._origin) * 1e6
+
+    def _track(self, owner):
+        # Tracks are kept after their owner is deleted, whose id can then be reused by a new owner.
+        track = self._tracks.get(id(owner))
+        if track is None or track.owner() is not owner:
+            tid = len(self._track_list) + 1
+            track = self._tracks[id(owner)] = _Track(owner, tid, '{} {}'.format(type(owner).__name__, tid))
+            self._track_list.append(track)
+        return track
+
+    def on_attach(self, owner):
+        with self._lock:
+            track = self._track(owner)
+
+        logger = getattr(owner, '_logger', None)
+        if logger is not None and track.listener is None:
+            track.listener = lambda level, message: self._on_message(track, message)
+            logger.add_listener(track.listener, logging.INFO)
+
+    def on_detach(self, owner):
+        with self._lock:
+            track = self._track(owner)
+        if track.listener is not None:
+            owner._logger.remove_listener(track.listener)
+            track.listener = None
+
+    def _add_event(self, event):
+        if len(self._events) == self.max_events:
+            self.dropped_events += 1
+        self._events.append(event)
+
+    def _end_phase(self, track, end):
+        phase, start = track.phase
+        track.phase = None
+        self._add_event({'name': phase, 'cat': 'phase', 'ph': 'X', 'pid': 1, 'tid': track.tid,
+                         'ts': self._timestamp(start), 'dur': self._timestamp(end) - self._timestamp(start)})
+
+    def _on_message(self, track, message):
+        phase = Progress.phase_of(message)
+        if phase is None:
+            return
+
+        now = time.perf_counter()
+        with self._lock:
+            if track.phase is not None:
+                if track.phase[0] == phase:
+                    return
+                self._end_phase(track, now)
+            track.phase = (phase, now)
+
+    def on_call(self, owner, name, args, result, start, end):
+        serial_number_index = _SERIAL_NUMBER_ARGUMENTS.get(name)
+
+        with self._lock:
+            track = self._track(owner)
+            if serial_number_index is not None and result == 0:
+                track.name = str(_value(args[serial_number_index]))
+
+            # A phase ends with the call it was logged in.
+            if track.phase is not None:
+                self._end_phase(track, end)
+
+            event = {'name': Instrumentation.short_name(name), 'cat': 'dll', 'ph': 'X', 'pid': 1, 'tid': track.tid,
+                     'ts': self._timestamp(start), 'dur': self._timestamp(end) - self._timestamp(start)}
+            if result:
+                event['args'] = {'result': result}
+            self._add_event(event)
+
+    def to_dict(self):
+        """
+        @return dict: The timeline in trace_event JSON object format. otherData holds the number of dropped events.
+        """
+        with self._lock:
+            metadata = [{'name': 'process_name', 'ph': 'M', 'pid': 1, 'args': {'name': self.process_name}}]
+            for track in self._track_list:
+                metadata.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': track.tid, 'args': {'name': track.name}})
+                metadata.append({'name': 'thread_sort_index', 'ph': 'M', 'pid': 1, 'tid': track.tid, 'args': {'sort_index': track.tid}})
+            return {'traceEvents': metadata + list(self._events), 'displayTimeUnit': 'ms',
+                    'otherData': {'dropped_events': self.dropped_events}}
+
+    def save(self, file_path):
+        """
+        Writes the timeline recorded so far to a JSON file.
+
+        @param str file_path: Path of the file to write.
+        """
+        trace = self.to_dict()
+        temporary_path = '{}.tmp'.format(file_path)
+        with open(temporary_path, 'w') as trace_file:
+            json.dump(trace, trace_file)
+        os.replace(temporary_path, file_path)
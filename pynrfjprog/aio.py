@@ -0,0 +1,200 @@
+"""
+This module provides asyncio front-ends for the LowLevel and HighLevel APIs.
+
+The wrapped calls run on an executor owned by the wrapper instance, so they do not block the event loop. The executor
+has a single worker: calls to one instance are serialized in submission order, while separate instances run concurrently.
+
+Timeouts and cancellation act on the awaiting coroutine. A call that is still queued is dropped. A call that the DLL is
+already executing cannot be interrupted and runs to completion in the worker thread, and later calls on the same
+instance wait for it.
+
+Example:
+    async def job():
+        async with aio.AsyncAPI(LowLevel.API('NRF52')) as api:
+            await api.call('connect_to_emu_without_snr')
+            await api.program_file('image.hex', timeout=60)
+"""
+
+import asyncio
+import concurrent.futures
+import functools
+
+try:
+    from . import LowLevel
+    from . import HighLevel
+    from .Parameters import *
+except Exception:
+    import LowLevel
+    import HighLevel
+    from Parameters import *
+
+
+def _given(**kwargs):
+    """ Returns the keyword arguments that are not None, so that the wrapped method applies its own defaults. """
+    return dict((name, value) for name, value in kwargs.items() if value is not None)
+
+
+class _AsyncWrapper(object):
+    """ Runs the methods of a wrapped object on a dedicated single-worker executor. """
+
+    def __init__(self, target, timeout=None):
+        """
+        @param object target: Object to wrap.
+        @param (optional) float timeout: Default timeout in seconds of the calls. None waits forever.
+        """
+        self._target = target
+        self._executor = concurrent.futures.ThreadPoolExecutor(max_workers=1)
+        self.timeout = timeout
+
+    @property
+    def target(self):
+        """ The wrapped object. It must not be used directly while calls are pending on the wrapper. """
+        return self._target
+
+    async def call(self, function_name, *args, timeout=None, **kwargs):
+        """
+        Runs a method of the wrapped object on the executor.
+
+        @param str function_name: Name of the method to call.
+        @param (optional) float timeout: Timeout in seconds, overrides the default timeout of the wrapper.
+        @return: Value returned by the method.
+        @raise asyncio.TimeoutError: The call did not complete in time.
+        """
+        return await self._run(functools.partial(getattr(self._target, function_name), *args, **kwargs), timeout)
+
+    async def _run(self, function, timeout=None):
+        """ Runs function on the executor. """
+        future = asyncio.get_running_loop().run_in_executor(self._executor, function)
+
+        timeout = self.timeout if timeout is None else timeout
+        if timeout is None:
+            return await future
+        return await asyncio.wait_for(future, timeout)
+
+    async def close(self, timeout=None):
+        """
+        Closes the wrapped object after the pending calls, then stops the executor.
+        """
+        try:
+            await self.call('close', timeout=timeout)
+        finally:
+            self._executor.shutdown(wait=False)
+
+    async def __aenter__(self):
+        return self
+
+    async def __aexit__(self, ex_type, ex_value, traceback):
+        await self.close()
+
+
+class AsyncAPI(_AsyncWrapper):
+    """
+    Asyncio front-end of LowLevel.API. Methods not listed here are available through call().
+    The API is opened by open() or when entering the async context manager, if it is not open already.
+    """
+
+    def __init__(self, api, timeout=None):
+        """
+        @param LowLevel.API api: API to wrap.
+        @param (optional) float timeout: Default timeout in seconds of the calls. None waits forever.
+        """
+        if not isinstance(api, LowLevel.API):
+            raise TypeError('The api parameter must be an instance of LowLevel.API.')
+
+        super(AsyncAPI, self).__init__(api, timeout)
+
+    async def open(self, timeout=None):
+        """
+        Opens the API on the executor if it is not open already.
+        """
+        def open_api():
+            if not self._target.is_open():
+                self._target.open()
+
+        await self._run(open_api, timeout)
+
+    async def __aenter__(self):
+        await self.open()
+        return self
+
+    async def program_file(self, file_path, timeout=None):
+        return await self.call('program_file', file_path, timeout=timeout)
+
+    async def verify_file(self, file_path, verify_action=None, timeout=None):
+        return await self.call('verify_file', file_path, timeout=timeout, **_given(verify_action=verify_action))
+
+    async def erase_all(self, timeout=None):
+        return await self.call('erase_all', timeout=timeout)
+
+    async def recover(self, timeout=None):
+        return await self.call('recover', timeout=timeout)
+
+    async def qspi_init(self, retain_ram=False, init_params=None, timeout=None):
+        return await self.call('qspi_init', retain_ram, init_params, timeout=timeout)
+
+    async def qspi_uninit(self, timeout=None):
+        return await self.call('qspi_uninit', timeout=timeout)
+
+    async def qspi_read(self, addr, length, timeout=None):
+        return await self.call('qspi_read', addr, length, timeout=timeout)
+
+    async def qspi_read_into(self, addr, buffer, timeout=None):
+        return await self.call('qspi_read_into', addr, buffer, timeout=timeout)
+
+    async def qspi_write(self, addr, data, timeout=None):
+        return await self.call('qspi_write', addr, data, timeout=timeout)
+
+    async def qspi_erase(self, addr, length, timeout=None):
+        return await self.call('qspi_erase', addr, length, timeout=timeout)
+
+    async def rtt_read(self, channel_index, length, encoding='utf-8', timeout=None):
+        return await self.call('rtt_read', channel_index, length, encoding, timeout=timeout)
+
+    async def rtt_read_into(self, channel_index, buffer, timeout=None):
+        return await self.call('rtt_read_into', channel_index, buffer, timeout=timeout)
+
+    async def rtt_write(self, channel_index, msg, encoding='utf-8', timeout=None):
+        return await self.call('rtt_write', channel_index, msg, encoding, timeout=timeout)
+
+
+class AsyncProbe(_AsyncWrapper):
+    """
+    Asyncio front-end of a HighLevel probe. Methods not listed here are available through call().
+    The rtt functions are only available when wrapping a HighLevel.DebugProbe.
+    Optional parameters left to None take the defaults of the wrapped probe, i.e. the verify action of its class.
+    """
+
+    def __init__(self, probe, timeout=None):
+        """
+        @param HighLevel.Probe probe: Opened probe to wrap.
+        @param (optional) float timeout: Default timeout in seconds of the calls. None waits forever.
+        """
+        if not isinstance(probe, HighLevel.Probe):
+            raise TypeError('The probe parameter must be an instance of HighLevel.Probe.')
+
+        super(AsyncProbe, self).__init__(probe, timeout)
+
+    async def program(self, hex_path, program_options=None, timeout=None):
+        return await self.call('program', hex_path, timeout=timeout, **_given(program_options=program_options))
+
+    async def verify(self, hex_path, verify_action=None, timeout=None):
+        return await self.call('verify', hex_path, timeout=timeout, **_given(verify_action=verify_action))
+
+    async def erase(self, erase_action=None, start_address=None, end_address=None, timeout=None):
+        return await self.call('erase', timeout=timeout, **_given(erase_action=erase_action, start_address=start_address,
+                                                                   end_address=end_address))
+
+    async def recover(self, timeout=None):
+        return await self.call('recover', timeout=timeout)
+
+    async def reset(self, reset_action=None, timeout=None):
+        return await self.call('reset', timeout=timeout, **_given(reset_action=reset_action))
+
+    async def rtt_read(self, channel_index, length, encoding='utf-8', timeout=None):
+        return await self.call('rtt_read', channel_index, length, encoding, timeout=timeout)
+
+    async def rtt_read_into(self, channel_index, buffer, timeout=None):
+        return await self.call('rtt_read_into', channel_index, buffer, timeout=timeout)
+
+    async def rtt_write(self, channel_index, msg, encoding='utf-8', timeout=None):
+        return await self.call('rtt_write', channel_index, msg, encoding, timeout=timeout)
@@ -10,6 +10,12 @@ try:
     from . import highlevel_program_hex
     from . import highlevel_memory_read_write
     from . import nrf9160_pca20035_modem_upgrade_over_serial
+    from . import api_pool_startup
+    from . import rtt_polling_benchmark
+    from . import gang_programming_benchmark
+    from . import buffer_validation_benchmark
+    from . import logger_scaling_benchmark
+    from . import progress_events
 
 except Exception:
     import python_help
@@ -18,3 +24,9 @@ except Exception:
     import highlevel_program_hex
     import highlevel_memory_read_write
     import nrf9160_pca20035_modem_upgrade_over_serial
+    import api_pool_startup
+    import rtt_polling_benchmark
+    import gang_programming_benchmark
+    import buffer_validation_benchmark
+    import logger_scaling_benchmark
+    import progress_events
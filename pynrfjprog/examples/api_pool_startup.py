@@ -0,0 +1,72 @@
+"""
+
+    This file contains example code meant to be used in order to compare the
+    startup latency of a cold LowLevel API with an API taken from an APIPool.
+    No debug probe needs to be connected.
+
+    Sample program: api_pool_startup.py
+
+    Run from command line:
+        python api_pool_startup.py
+    or if imported using "from pynrfjprog import examples"
+        examples.api_pool_startup.run()
+
+    Program flow:
+        0. An API object is opened and closed several times, and the time of each open is measured.
+        1. An APIPool is created and an API is checked out once to warm it up.
+        2. An API is checked out from the pool several times, and the time of each checkout is measured.
+        3. The median time of both methods is printed to console.
+
+"""
+
+from __future__ import print_function
+
+import statistics
+import time
+
+# Import pynrfjprog API module
+try:
+    from .. import LowLevel
+    from .. import APIPool
+except Exception:
+    from pynrfjprog import LowLevel
+    from pynrfjprog import APIPool
+
+
+def run(device_family=LowLevel.DeviceFamily.NRF52, iterations=10):
+    """
+    Run example script.
+
+    @param (optional) DeviceFamily device_family: Device family to open the API with.
+    @param (optional) int iterations: Number of measurements of each method.
+    """
+    print('# API pool startup latency example using pynrfjprog started...')
+
+    print('# Opening and closing a new API {} times.'.format(iterations))
+    cold = list()
+    for _ in range(iterations):
+        api = LowLevel.API(device_family)
+        start = time.perf_counter()
+        api.open()
+        cold.append(time.perf_counter() - start)
+        api.close()
+
+    print('# Checking out an API from a warm pool {} times.'.format(iterations))
+    pooled = list()
+    with APIPool.APIPool() as pool:
+        with pool.checkout(device_family):
+            pass
+
+        for _ in range(iterations):
+            start = time.perf_counter()
+            with pool.checkout(device_family):
+                pooled.append(time.perf_counter() - start)
+
+    print('Cold open median:       {:8.3f} ms'.format(statistics.median(cold) * 1000))
+    print('Pooled checkout median: {:8.3f} ms'.format(statistics.median(pooled) * 1000))
+
+    print('# Example done...')
+
+
+if __name__ == '__main__':
+    run()
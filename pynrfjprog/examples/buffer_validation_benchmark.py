@@ -0,0 +1,70 @@
+"""
+
+    This file contains example code meant to be used in order to measure the
+    per-call overhead of validating and converting write buffers before they are passed to the DLL.
+    No debug probe needs to be connected.
+
+    Sample program: buffer_validation_benchmark.py
+
+    Run from command line:
+        python buffer_validation_benchmark.py
+    or if imported using "from pynrfjprog import examples"
+        examples.buffer_validation_benchmark.run()
+
+    Program flow:
+        0. Payloads of 4 B, 4 KB and 1 MB are created as bytes, bytearray and list objects.
+        1. For each payload, is_valid_buf() and to_c_uint8_array() are timed, as done by LowLevel.API.write.
+        2. A check of every item with is_u8(), as done by earlier versions of is_valid_buf(), is timed for reference.
+        3. The time per call of both is printed to console.
+
+"""
+
+from __future__ import print_function
+
+import timeit
+
+# Import pynrfjprog API module
+try:
+    from .. import Parameters
+except Exception:
+    from pynrfjprog import Parameters
+
+
+def _per_item_check(buf):
+    """ Validation of earlier versions of is_valid_buf(), one Python call per item. """
+    for value in buf:
+        if not Parameters.is_u8(value):
+            return False
+    return True
+
+
+def _time_per_call(function, max_seconds=0.2):
+    """ Returns the time in microseconds of one call of function, repeated for about max_seconds. """
+    timer = timeit.Timer(function)
+    number, elapsed = timer.autorange()
+    if elapsed < max_seconds:
+        number = max(1, int(number * max_seconds / elapsed))
+    return min(timer.repeat(3, number)) / number * 1e6
+
+
+def run(sizes=(4, 4096, 1024 * 1024)):
+    """
+    Run example script.
+
+    @param (optional) [int] sizes: Payload sizes in bytes.
+    """
+    print('# Buffer validation benchmark using pynrfjprog started...')
+
+    print('{:>10} {:>10} {:>18} {:>18}'.format('payload', 'type', 'validate+convert', 'per-item check'))
+    for size in sizes:
+        data = bytes(range(256)) * (size // 256) + bytes(size % 256)
+        for payload in (data, bytearray(data), list(data)):
+            current = _time_per_call(lambda: Parameters.is_valid_buf(payload) and Parameters.to_c_uint8_array(payload))
+            reference = _time_per_call(lambda: _per_item_check(payload))
+            print('{:>10} {:>10} {:>15.1f} us {:>15.1f} us'.format(size, type(payload).__name__, current, reference))
+
+    print('# Example done...')
+
+
+if __name__ == '__main__':
+    run()
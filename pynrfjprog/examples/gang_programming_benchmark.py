@@ -0,0 +1,77 @@
+"""
+
+    This file contains example code meant to be used in order to measure how the
+    aggregate throughput of a GangProgrammer scales with the number of probes, on the simulated backend.
+    No debug probe needs to be connected.
+
+    Sample program: gang_programming_benchmark.py
+
+    Run from command line:
+        python gang_programming_benchmark.py
+    or if imported using "from pynrfjprog import examples"
+        examples.gang_programming_benchmark.run()
+
+    Program flow:
+        0. For each probe count, simulated devices with a limited transfer rate are created.
+        1. A GangProgrammer programs and verifies the example hex file on all the devices, and the time is measured.
+        2. The aggregate throughput and the speedup over one probe are printed to console.
+
+"""
+
+from __future__ import print_function
+
+import os
+import time
+
+# Import pynrfjprog API module
+try:
+    from .. import GangProgrammer
+    from .. import HighLevel
+    from .. import Hex
+    from .. import Simulator
+except Exception:
+    from pynrfjprog import GangProgrammer
+    from pynrfjprog import HighLevel
+    from pynrfjprog import Hex
+    from pynrfjprog import Simulator
+
+
+def run(probe_counts=(1, 2, 4, 8, 16, 32), bytes_per_second=100000, call_latency=0.001):
+    """
+    Run example script.
+
+    @param (optional) [int] probe_counts: Numbers of simulated probes to program at the same time.
+    @param (optional) int bytes_per_second: Simulated transfer rate of each probe.
+    @param (optional) float call_latency: Simulated USB latency in seconds of each DLL call.
+    """
+    print('# Gang programming benchmark using pynrfjprog started...')
+
+    hex_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'nrf9160_pca20035_firmware_upgrade_app_0.1.0.hex')
+    image_size = sum(len(segment.data) for segment in Hex.Hex(hex_path))
+
+    print('{:>8} {:>10} {:>14} {:>9}'.format('probes', 'time s', 'total kB/s', 'speedup'))
+    single_rate = None
+    for count in probe_counts:
+        devices = [Simulator.SimulatedDevice(682000001 + index, bytes_per_second=bytes_per_second, call_latency=call_latency)
+                   for index in range(count)]
+
+        with Simulator.HighLevelAPI(devices, log=False) as api:
+            with GangProgrammer.GangProgrammer(api) as gang:
+                start = time.perf_counter()
+                results = gang.program(hex_path, verify_action=HighLevel.VerifyAction.VERIFY_READ)
+                elapsed = time.perf_counter() - start
+
+        failures = [result for result in results if not result.success]
+        if failures:
+            print('# Failed: {}'.format(failures))
+            return
+
+        rate = count * image_size / elapsed
+        single_rate = single_rate or rate
+        print('{:>8} {:>10.3f} {:>14.1f} {:>9.2f}'.format(count, elapsed, rate / 1000, rate / single_rate))
+
+    print('# Example done...')
+
+
+if __name__ == '__main__':
+    run()
@@ -0,0 +1,80 @@
+"""
+
+    This file contains example code meant to be used in order to check that the
+    cost of a log record does not grow with the number of API instances created, on the simulated backend.
+    No debug probe needs to be connected.
+
+    Sample program: logger_scaling_benchmark.py
+
+    Run from command line:
+        python logger_scaling_benchmark.py
+    or if imported using "from pynrfjprog import examples"
+        examples.logger_scaling_benchmark.run()
+
+    Program flow:
+        0. The LowLevel module logger is set to the DEBUG level, so that every record is handled.
+        1. Simulated LowLevel APIs with logging enabled are opened and closed, up to each checkpoint.
+        2. At each checkpoint, records are logged through a new API, and the time per record and the number of handlers of
+           the module logger are printed to console.
+
+"""
+
+from __future__ import print_function
+
+import logging
+import time
+
+# Import pynrfjprog API module
+try:
+    from .. import LowLevel
+    from .. import Simulator
+except Exception:
+    from pynrfjprog import LowLevel
+    from pynrfjprog import Simulator
+
+
+def _time_per_record(device, records):
+    """ Returns the time in microseconds to log one record through a new API. """
+    with Simulator.LowLevelAPI('NRF52', [device], log=True) as api:
+        start = time.perf_counter()
+        for index in range(records):
+            api._logger.debug('Benchmark record %d', index)
+        return (time.perf_counter() - start) / records * 1e6
+
+
+def run(checkpoints=(0, 1000, 5000, 10000), records=2000):
+    """
+    Run example script.
+
+    @param (optional) [int] checkpoints: Numbers of APIs opened and closed before each measurement.
+    @param (optional) int records: Number of records logged at each checkpoint.
+    """
+    print('# Logger scaling benchmark using pynrfjprog started...')
+
+    module_logger = logging.getLogger(LowLevel.__name__)
+    previous_level = module_logger.level
+    handler = logging.NullHandler()
+    module_logger.setLevel(logging.DEBUG)
+    module_logger.addHandler(handler)
+
+    device = Simulator.SimulatedDevice(682000001)
+    created = 0
+    try:
+        print('{:>10} {:>12} {:>18}'.format('APIs', 'us/record', 'module handlers'))
+        for checkpoint in checkpoints:
+            while created < checkpoint:
+                api = Simulator.LowLevelAPI('NRF52', [device], log=True)
+                api.open()
+                api.close()
+                created += 1
+            cost = _time_per_record(device, records)
+            print('{:>10} {:>12.2f} {:>18}'.format(checkpoint, cost, len(module_logger.handlers) - 1))
+    finally:
+        module_logger.removeHandler(handler)
+        module_logger.setLevel(previous_level)
+
+    print('# Example done...')
+
+
+if __name__ == '__main__':
+    run()
@@ -0,0 +1,60 @@
+"""
+
+    This file contains example code meant to be used in order to follow the
+    progress of LowLevel.API.program_file with the default constructor arguments, on the simulated backend.
+    No debug probe needs to be connected.
+
+    Sample program: progress_events.py
+
+    Run from command line:
+        python progress_events.py
+    or if imported using "from pynrfjprog import examples"
+        examples.progress_events.run()
+
+    Program flow:
+        0. A simulated LowLevel API is created with logging disabled, the default of LowLevel.API.
+        1. The example hex file is programmed with a progress callback, and the events are printed to console.
+        2. The events are checked to contain progress events between the start and end events.
+
+"""
+
+from __future__ import print_function
+
+import os
+
+# Import pynrfjprog API module
+try:
+    from .. import Simulator
+except Exception:
+    from pynrfjprog import Simulator
+
+
+def run(snr=682000001, bytes_per_second=100000):
+    """
+    Run example script.
+
+    @param (optional) int snr: Serial number of the simulated probe.
+    @param (optional) int bytes_per_second: Simulated transfer rate of the probe.
+    """
+    print('# Progress events example using pynrfjprog started...')
+
+    hex_path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'nrf9160_pca20035_firmware_upgrade_app_0.1.0.hex')
+    device = Simulator.SimulatedDevice(snr, family='NRF91', bytes_per_second=bytes_per_second)
+
+    events = list()
+    with Simulator.LowLevelAPI('NRF91', [device]) as api:
+        api.connect_to_emu_with_snr(snr)
+        api.program_file(hex_path, progress=events.append)
+
+    for event in events:
+        print(event)
+
+    states = [event.state for event in events]
+    if states[0] != 'start' or states[-1] != 'end' or 'progress' not in states:
+        raise RuntimeError('Expected progress events between start and end, got {}.'.format(states))
+
+    print('# Example done...')
+
+
+if __name__ == '__main__':
+    run()
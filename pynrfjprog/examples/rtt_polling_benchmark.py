@@ -0,0 +1,113 @@
+"""
+
+    This file contains example code meant to be used in order to compare the
+    throughput and host CPU usage of RTT polling schedules on the simulated backend.
+    No debug probe needs to be connected.
+
+    Sample program: rtt_polling_benchmark.py
+
+    Run from command line:
+        python rtt_polling_benchmark.py
+    or if imported using "from pynrfjprog import examples"
+        examples.rtt_polling_benchmark.run()
+
+    Program flow:
+        0. Simulated devices are created. A firmware thread writes bursts of data to their RTT up channel 0, and counts
+           the bytes dropped when the RTT buffer of a device is full.
+        1. For each polling schedule, an RTTStream is opened on every device, and the bytes received, the bytes
+           dropped and the CPU time used by the process are measured for a while.
+        2. The results of each schedule are printed to console.
+
+"""
+
+from __future__ import print_function
+
+import threading
+import time
+
+# Import pynrfjprog API module
+try:
+    from .. import RTT
+    from .. import Simulator
+except Exception:
+    from pynrfjprog import RTT
+    from pynrfjprog import Simulator
+
+
+def _firmware(devices, rate, burst_period, stop, dropped):
+    """ Writes rate bytes per second to each device during the first half of each burst period. """
+    chunk = bytes(range(256)) * 64
+    previous = time.perf_counter()
+    while not stop.wait(0.001):
+        now = time.perf_counter()
+        if (now % burst_period) < burst_period / 2:
+            length = int(rate * (now - previous))
+            for device in devices:
+                sent = 0
+                while sent < length:
+                    block = chunk[:length - sent]
+                    accepted = device.rtt_send(0, block)
+                    if accepted < len(block):
+                        dropped[0] += len(block) - accepted
+                        break
+                    sent += accepted
+        previous = now
+
+
+def run(num_probes=20, duration=3.0, rate=200000, call_latency=0.0002):
+    """
+    Run example script.
+
+    @param (optional) int num_probes: Number of simulated devices.
+    @param (optional) float duration: Seconds measured for each schedule.
+    @param (optional) int rate: Bytes per second written by each device while it is active.
+    @param (optional) float call_latency: Simulated USB latency in seconds of each DLL call.
+    """
+    print('# RTT polling benchmark using pynrfjprog started...')
+
+    schedules = [
+        ('fixed 10 ms sleep', RTT.AdaptivePoller(0.01, 0.01)),
+        ('busy polling', RTT.AdaptivePoller(0.0, 0.0)),
+        ('adaptive', None),
+    ]
+
+    print('{:<20} {:>14} {:>10} {:>10}'.format('schedule', 'received kB/s', 'dropped', 'CPU %'))
+    for name, poller in schedules:
+        devices = [Simulator.SimulatedDevice(index + 1, rtt_buffer_size=1024, call_latency=call_latency) for index in range(num_probes)]
+        apis = list()
+        streams = list()
+        for device in devices:
+            api = Simulator.LowLevelAPI('NRF52', devices)
+            api.open()
+            api.connect_to_emu_with_snr(device.serial_number)
+            apis.append(api)
+            streams.append(RTT.RTTStream(api, channels=[0], ring_size=1 << 22,
+                                         poller=RTT.AdaptivePoller(poller.min_interval, poller.max_interval) if poller else None))
+
+        stop = threading.Event()
+        dropped = [0]
+        firmware = threading.Thread(target=_firmware, args=(devices, rate, 1.0, stop, dropped))
+
+        start_cpu = time.process_time()
+        start = time.perf_counter()
+        firmware.start()
+        time.sleep(duration)
+        stop.set()
+        firmware.join()
+        elapsed = time.perf_counter() - start
+        cpu = time.process_time() - start_cpu
+
+        for stream in streams:
+            stream.close()
+        received = sum(stream.channels[0].available() for stream in streams)
+        for api in apis:
+            api.close()
+
+        print('{:<20} {:>14.1f} {:>9.1f}% {:>10.1f}'.format(
+            name, received / elapsed / 1000, 100.0 * dropped[0] / max(received + dropped[0], 1), 100.0 * cpu / elapsed))
+
+    print('# Example done...')
+
+
+if __name__ == '__main__':
+    run()